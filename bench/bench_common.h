@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <imgui.h>
+#include <imfilebrowser.h>
+
+namespace ImGui
+{
+    struct FileBrowserInternals
+    {
+        using FileRecordTable   = FileBrowser::FileRecordTable;
+        using TypeFilterMatcher = FileBrowser::TypeFilterMatcher;
+        using EnumerationStats  = FileBrowser::EnumerationStats;
+
+        static bool BuildFileRecord(
+            const std::filesystem::directory_entry &entry, FileRecordTable &records, EnumerationStats &stats)
+        {
+            return FileBrowser::BuildFileRecord(entry, 0, records, stats);
+        }
+
+        static void SortFileRecords(FileRecordTable &records, size_t parallelSortThreshold)
+        {
+            FileBrowser::SortFileRecords(records, parallelSortThreshold);
+        }
+
+        // sorts chunkCount chunks in parallel and merges them whatever the number of hardware threads
+        static void SortFileRecordsInChunks(FileRecordTable &records, size_t chunkCount)
+        {
+            FileBrowser::SortFileRecordsInChunks(records, chunkCount);
+        }
+
+        static size_t GetParallelSortChunkCount(size_t recordCount)
+        {
+            return FileBrowser::GetParallelSortChunkCount(recordCount);
+        }
+
+        // rebuild the list of visible entries like the first frame after a change does
+        static size_t UpdateVisibleRecords(FileBrowser &browser)
+        {
+            browser.visibleRecordIndicesDirty_ = true;
+            browser.UpdateVisibleRecordIndices();
+            return browser.visibleRecordIndices_.size();
+        }
+    };
+} // namespace ImGui
+
+namespace bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    inline double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // returns the given percentile (0 to 100) of samples
+    inline double Percentile(std::vector<double> samples, double percentile)
+    {
+        if(samples.empty())
+        {
+            return 0;
+        }
+        const size_t index = (std::min)(
+            samples.size() - 1, static_cast<size_t>(percentile / 100 * static_cast<double>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    // deterministic pseudo random numbers, so that every run generates the same names
+    class Random
+    {
+    public:
+
+        explicit Random(uint32_t seed) : state_(seed ? seed : 1) { }
+
+        uint32_t Next() noexcept
+        {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 17;
+            state_ ^= state_ << 5;
+            return state_;
+        }
+
+        template <class T>
+        const T &Pick(const std::vector<T> &values) noexcept
+        {
+            return values[Next() % values.size()];
+        }
+
+    private:
+
+        uint32_t state_;
+    };
+
+    // unique names in mixed case with mixed extensions, numbers and some non-ascii letters
+    inline std::vector<std::string> GenerateNames(size_t count, uint32_t seed)
+    {
+        static const std::vector<std::string> words = {
+            "report", "Image", "data", "README", "main", "Test", "backup", "IMG", "notes", "Makefile",
+            "r\xC3\xA9sum\xC3\xA9", "\xCE\xB1lpha", "build_output", "Frame" };
+        static const std::vector<std::string> extensions = {
+            ".txt", ".cpp", ".h", ".PNG", ".jpg", ".tar.gz", ".JSON", ".Md", "", ".log" };
+
+        Random random(seed);
+        std::vector<std::string> names;
+        names.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            names.push_back(random.Pick(words) + "_" + std::to_string(i) + random.Pick(extensions));
+        }
+        return names;
+    }
+
+    // fill dir with entryCount entries. one in ten entries is a directory. one in a hundred directories contains a
+    // chain of nested directories with a file at each level
+    inline void CreateTree(const std::filesystem::path &dir, size_t entryCount)
+    {
+        constexpr int NESTING_DEPTH = 16;
+
+        std::filesystem::create_directories(dir);
+        const std::vector<std::string> names = GenerateNames(entryCount, static_cast<uint32_t>(entryCount));
+        for(size_t i = 0; i < names.size(); ++i)
+        {
+            const std::filesystem::path path = dir / std::filesystem::u8path(names[i]);
+            if(i % 10 != 0)
+            {
+                std::ofstream(path, std::ios::binary) << i;
+                continue;
+            }
+
+            std::filesystem::create_directory(path);
+            if(i % 1000 == 0)
+            {
+                std::filesystem::path nested = path;
+                for(int depth = 0; depth < NESTING_DEPTH; ++depth)
+                {
+                    nested /= "level" + std::to_string(depth);
+                    std::filesystem::create_directory(nested);
+                    std::ofstream(nested / "file.txt", std::ios::binary) << depth;
+                }
+            }
+        }
+    }
+
+    // a directory under the system temp directory, removed with its content on destruction
+    class TempDirectory
+    {
+    public:
+
+        explicit TempDirectory(const std::string &name)
+            : path_(std::filesystem::temp_directory_path() / name)
+        {
+            std::filesystem::remove_all(path_);
+            std::filesystem::create_directories(path_);
+        }
+
+        TempDirectory(const TempDirectory &) = delete;
+
+        TempDirectory &operator=(const TempDirectory &) = delete;
+
+        ~TempDirectory()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path_, ec);
+        }
+
+        const std::filesystem::path &GetPath() const noexcept { return path_; }
+
+    private:
+
+        std::filesystem::path path_;
+    };
+
+    // collects results and writes them as a single json object:
+    //     { "benchmark": ..., "label": ..., "hardware_threads": ..., "results": [ { "name": ..., ... }, ... ] }
+    class JsonResults
+    {
+    public:
+
+        JsonResults(std::string benchmark, std::string label)
+            : benchmark_(std::move(benchmark)), label_(std::move(label))
+        {
+
+        }
+
+        // fields are written in the order they are given
+        void Add(const std::string &name, const std::vector<std::pair<std::string, double>> &fields)
+        {
+            std::ostringstream out;
+            out << "{ \"name\": \"" << name << "\"";
+            for(auto &field : fields)
+            {
+                out << ", \"" << field.first << "\": " << field.second;
+            }
+            out << " }";
+            results_.push_back(out.str());
+
+            // progress for humans
+            std::cerr << out.str() << std::endl;
+        }
+
+        void Write(std::ostream &out) const
+        {
+            out << "{\n";
+            out << "  \"benchmark\": \"" << benchmark_ << "\",\n";
+            out << "  \"label\": \"" << label_ << "\",\n";
+            out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+            out << "  \"results\": [\n";
+            for(size_t i = 0; i < results_.size(); ++i)
+            {
+                out << "    " << results_[i] << (i + 1 < results_.size() ? ",\n" : "\n");
+            }
+            out << "  ]\n";
+            out << "}\n";
+        }
+
+        // write to filename, or to stdout if filename is empty. returns false on failure
+        bool Write(const std::string &filename) const
+        {
+            if(filename.empty())
+            {
+                Write(std::cout);
+                return true;
+            }
+            std::ofstream file(filename);
+            Write(file);
+            return static_cast<bool>(file);
+        }
+
+    private:
+
+        std::string              benchmark_;
+        std::string              label_;
+        std::vector<std::string> results_;
+    };
+
+    // parses "--name value" pairs. returns false if an argument is not recognized
+    struct CommandLine
+    {
+        std::vector<size_t> sizes;
+        int                 repeatCount = 5;
+        int                 frameCount = 300;
+        std::string         output;
+        std::string         label;
+
+        bool Parse(int argc, char **argv)
+        {
+            for(int i = 1; i + 1 < argc; i += 2)
+            {
+                const std::string name = argv[i], value = argv[i + 1];
+                if(name == "--sizes")
+                {
+                    sizes.clear();
+                    std::istringstream in(value);
+                    for(std::string size; std::getline(in, size, ',');)
+                    {
+                        sizes.push_back(std::stoull(size));
+                    }
+                }
+                else if(name == "--repeat")
+                {
+                    repeatCount = (std::max)(1, std::stoi(value));
+                }
+                else if(name == "--frames")
+                {
+                    frameCount = (std::max)(1, std::stoi(value));
+                }
+                else if(name == "--output")
+                {
+                    output = value;
+                }
+                else if(name == "--label")
+                {
+                    label = value;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            return argc % 2 == 1;
+        }
+    };
+} // namespace bench
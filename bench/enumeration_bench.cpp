@@ -0,0 +1,221 @@
+// times the phases of listing a directory on generated directories of increasing size, and type filtering.
+// sort_parallel reports the speedup of the parallel sort (see FileBrowser::SetParallelSortThreshold), which is
+// omitted when the machine would sort in a single chunk
+// usage:
+//     imfilebrowser_enumeration_bench [--sizes 1000,10000,100000,1000000] [--repeat 5]
+//                                     [--output results.json] [--label commit]
+// results are written as json (to stdout by default). times are in milliseconds
+
+#include "bench_common.h"
+
+using Internals = ImGui::FileBrowserInternals;
+
+namespace
+{
+    const std::vector<std::string> TYPE_FILTERS = {
+        ".txt", ".cpp", ".h", ".png", ".jpg", ".tar.gz", ".json", "Makefile", "*_1*.log", "README*", ".md", ".*" };
+
+    struct Phases
+    {
+        std::vector<double> iterate;      // directory iteration only
+        std::vector<double> buildRecords; // building records and collation keys from directory entries
+        std::vector<double> sort;
+        std::vector<double> sortParallel; // sorting with the parallel path forced on
+        std::vector<double> updateFileRecords;          // whole listing through FileBrowser::SetDirectory
+        std::vector<double> updateFileRecordsEnumerate; // enumeration part as reported by GetStats
+        std::vector<double> updateFileRecordsSort;      // sort part as reported by GetStats
+    };
+
+    std::vector<std::filesystem::directory_entry> ReadEntries(const std::filesystem::path &dir)
+    {
+        std::vector<std::filesystem::directory_entry> entries;
+        for(auto &entry : std::filesystem::directory_iterator(dir))
+        {
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+    Internals::FileRecordTable BuildRecords(const std::vector<std::filesystem::directory_entry> &entries)
+    {
+        Internals::FileRecordTable records;
+        Internals::EnumerationStats stats;
+        records.Add(true, "..");
+        for(auto &entry : entries)
+        {
+            Internals::BuildFileRecord(entry, records, stats);
+        }
+        return records;
+    }
+
+    void MeasureListing(const std::filesystem::path &dir, int repeatCount, Phases &phases)
+    {
+        ImGui::FileBrowser browser(0, dir.parent_path());
+        browser.SetNavigationDebounceTime(std::chrono::milliseconds(0));
+        browser.SetListingCacheCapacity(0, 0);
+
+        for(int i = 0; i < repeatCount; ++i)
+        {
+            auto startTime = bench::Clock::now();
+            const auto entries = ReadEntries(dir);
+            phases.iterate.push_back(bench::MillisecondsSince(startTime));
+
+            startTime = bench::Clock::now();
+            auto records = BuildRecords(entries);
+            phases.buildRecords.push_back(bench::MillisecondsSince(startTime));
+
+            startTime = bench::Clock::now();
+            Internals::SortFileRecords(records, SIZE_MAX);
+            phases.sort.push_back(bench::MillisecondsSince(startTime));
+
+            records = BuildRecords(entries);
+            startTime = bench::Clock::now();
+            Internals::SortFileRecords(records, 0);
+            phases.sortParallel.push_back(bench::MillisecondsSince(startTime));
+
+            browser.SetDirectory(dir.parent_path());
+            startTime = bench::Clock::now();
+            browser.SetDirectory(dir);
+            phases.updateFileRecords.push_back(bench::MillisecondsSince(startTime));
+
+            const auto stats = browser.GetStats();
+            phases.updateFileRecordsEnumerate.push_back(stats.enumerationMs);
+            phases.updateFileRecordsSort.push_back(stats.sortMs);
+        }
+    }
+
+    void AddTiming(
+        bench::JsonResults &results, const std::string &name, size_t entryCount, const std::vector<double> &samples,
+        std::vector<std::pair<std::string, double>> extraFields = {})
+    {
+        std::vector<std::pair<std::string, double>> fields = {
+            { "entries",   static_cast<double>(entryCount) },
+            { "median_ms", bench::Percentile(samples, 50) },
+            { "min_ms",    *std::min_element(samples.begin(), samples.end()) },
+            { "samples",   static_cast<double>(samples.size()) } };
+        fields.insert(fields.end(), extraFields.begin(), extraFields.end());
+        results.Add(name, fields);
+    }
+
+    // matches every generated name against each type filter, like building the filtered view does
+    void MeasureTypeFilterMatching(
+        const std::vector<std::string> &names, int repeatCount, bench::JsonResults &results)
+    {
+        // ".*" would match everything without looking at the names
+        Internals::TypeFilterMatcher matcher;
+        for(auto &filter : TYPE_FILTERS)
+        {
+            if(filter != ".*")
+            {
+                matcher.Add(filter);
+            }
+        }
+
+        std::vector<std::string> extensions;
+        extensions.reserve(names.size());
+        for(auto &name : names)
+        {
+            extensions.push_back(std::filesystem::u8path(name).extension().u8string());
+        }
+
+        std::vector<double> samples;
+        size_t matchCount = 0;
+        std::string scratch;
+        for(int i = 0; i < repeatCount; ++i)
+        {
+            const auto startTime = bench::Clock::now();
+            for(size_t j = 0; j < names.size(); ++j)
+            {
+                matchCount += matcher.IsMatched(names[j], extensions[j], scratch);
+            }
+            samples.push_back(bench::MillisecondsSince(startTime));
+        }
+
+        const double medianMs = bench::Percentile(samples, 50);
+        results.Add("type_filter_match", {
+            { "entries",       static_cast<double>(names.size()) },
+            { "median_ms",     medianMs },
+            { "min_ms",        *std::min_element(samples.begin(), samples.end()) },
+            { "names_per_sec", medianMs > 0 ? static_cast<double>(names.size()) / (medianMs / 1000) : 0 },
+            { "matched",       static_cast<double>(matchCount / static_cast<size_t>(repeatCount)) } });
+    }
+
+    // SetTypeFilters followed by rebuilding the view of a directory, for every filter in turn
+    void MeasureSetTypeFilters(const std::filesystem::path &dir, int repeatCount, bench::JsonResults &results)
+    {
+        ImGui::FileBrowser browser(0, dir);
+        std::vector<double> setSamples, viewSamples;
+        for(int i = 0; i < repeatCount; ++i)
+        {
+            auto startTime = bench::Clock::now();
+            browser.SetTypeFilters(TYPE_FILTERS);
+            setSamples.push_back(bench::MillisecondsSince(startTime));
+
+            startTime = bench::Clock::now();
+            for(int filter = 0; filter < static_cast<int>(TYPE_FILTERS.size()); ++filter)
+            {
+                browser.SetCurrentTypeFilterIndex(filter);
+                Internals::UpdateVisibleRecords(browser);
+            }
+            viewSamples.push_back(bench::MillisecondsSince(startTime) / static_cast<double>(TYPE_FILTERS.size()));
+        }
+
+        const size_t entryCount = browser.GetStats().recordCount;
+        AddTiming(results, "set_type_filters", entryCount, setSamples);
+        AddTiming(results, "filter_view_per_type_filter", entryCount, viewSamples);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::CommandLine commandLine;
+    commandLine.sizes = { 1000, 10000, 100000, 1000000 };
+    if(!commandLine.Parse(argc, argv))
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " [--sizes 1000,10000,100000,1000000] [--repeat 5] [--output results.json] [--label text]\n";
+        return 1;
+    }
+
+    bench::JsonResults results("imfilebrowser_enumeration", commandLine.label);
+    bench::TempDirectory root("imfilebrowser_enumeration_bench");
+    for(const size_t size : commandLine.sizes)
+    {
+        const std::filesystem::path dir = root.GetPath() / ("entries_" + std::to_string(size));
+
+        const auto startTime = bench::Clock::now();
+        bench::CreateTree(dir, size);
+        std::cerr << "generated " << size << " entries in " << bench::MillisecondsSince(startTime) << " ms\n";
+
+        Phases phases;
+        MeasureListing(dir, commandLine.repeatCount, phases);
+        AddTiming(results, "iterate", size, phases.iterate);
+        AddTiming(results, "build_records", size, phases.buildRecords);
+        AddTiming(results, "sort", size, phases.sort);
+        // with a single chunk both timings are of the same sequential sort, and their ratio is only noise
+        const size_t chunkCount = Internals::GetParallelSortChunkCount(size);
+        std::vector<std::pair<std::string, double>> parallelFields = { { "chunks", static_cast<double>(chunkCount) } };
+        if(chunkCount > 1)
+        {
+            parallelFields.push_back(
+                { "speedup", bench::Percentile(phases.sort, 50) / bench::Percentile(phases.sortParallel, 50) });
+        }
+        AddTiming(results, "sort_parallel", size, phases.sortParallel, parallelFields);
+        AddTiming(results, "update_file_records", size, phases.updateFileRecords);
+        AddTiming(results, "update_file_records_enumerate", size, phases.updateFileRecordsEnumerate);
+        AddTiming(results, "update_file_records_sort", size, phases.updateFileRecordsSort);
+
+        MeasureTypeFilterMatching(
+            bench::GenerateNames(size, static_cast<uint32_t>(size)), commandLine.repeatCount, results);
+        MeasureSetTypeFilters(dir, commandLine.repeatCount, results);
+
+        std::filesystem::remove_all(dir);
+    }
+
+    if(!results.Write(commandLine.output))
+    {
+        std::cerr << "failed to write " << commandLine.output << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,350 @@
+// runs a file browser in a headless dear imgui context through scripted frames and reports frame times and heap
+// allocations for each part of the script: idle frames, wheel scrolling, click and shift-click range selection,
+// ctrl+a, switching type filters, and navigating into nested directories and back with alt+left or by clicking
+// a button of the current path.
+// usage:
+//     imfilebrowser_frame_bench [--sizes 100000] [--frames 300] [--output results.json] [--label commit]
+// results are written as json (to stdout by default). times are in milliseconds
+
+#include "bench_common.h"
+
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <new>
+
+// allocations made through operator new by the thread running the frames. background threads of the browser are
+// not counted, so that the numbers do not depend on how far they got during a frame. dear imgui allocates with
+// malloc and is not counted either
+namespace
+{
+    thread_local size_t allocationCount = 0;
+} // namespace
+
+// gcc sees the replaced operators pairing new with free through inlining, which is fine as they replace both sides
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+    ++allocationCount;
+    if(void *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    constexpr float DISPLAY_WIDTH = 1280;
+    constexpr float DISPLAY_HEIGHT = 720;
+
+    // rows of the file list in a 1280x720 browser window at the top left corner
+    const ImVec2 FIRST_CLICK_POS = ImVec2(200, 250);
+    const ImVec2 RANGE_CLICK_POS = ImVec2(200, 500);
+
+    const std::vector<std::string> TYPE_FILTERS = { ".*", ".txt", ".cpp", ".h", ".PNG", ".jpg", ".tar.gz", ".log" };
+
+    struct FrameSamples
+    {
+        std::vector<double> milliseconds;
+        std::vector<double> allocations;
+    };
+
+    // owns the headless imgui context. fonts are built so that NewFrame does not assert, nothing is rendered
+    class HeadlessContext
+    {
+    public:
+
+        HeadlessContext()
+        {
+            IMGUI_CHECKVERSION();
+            ImGui::CreateContext();
+
+            ImGuiIO &io = ImGui::GetIO();
+            io.IniFilename = nullptr;
+            io.DisplaySize = ImVec2(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+            io.DeltaTime = 1.0f / 60;
+            // the script clicks repeatedly at the same rows, which must not open them as double clicks
+            io.MouseDoubleClickTime = 0;
+
+            unsigned char *pixels = nullptr;
+            int width = 0, height = 0;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        }
+
+        HeadlessContext(const HeadlessContext &) = delete;
+
+        HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+        ~HeadlessContext()
+        {
+            ImGui::DestroyContext();
+        }
+    };
+
+    // one frame of the script. input is queued before the frame, browser calls are made inside it
+    struct ScriptedFrame
+    {
+        std::function<void(ImGuiIO &)>              input;
+        std::function<void(ImGui::FileBrowser &)>   action;
+    };
+
+    void RunFrame(ImGui::FileBrowser &browser, const ScriptedFrame &frame, FrameSamples *samples)
+    {
+        ImGuiIO &io = ImGui::GetIO();
+        if(frame.input)
+        {
+            frame.input(io);
+        }
+
+        const size_t allocationsBefore = allocationCount;
+        const auto startTime = bench::Clock::now();
+
+        ImGui::NewFrame();
+        if(frame.action)
+        {
+            frame.action(browser);
+        }
+        browser.Display();
+        ImGui::Render();
+
+        if(samples)
+        {
+            samples->milliseconds.push_back(bench::MillisecondsSince(startTime));
+            samples->allocations.push_back(static_cast<double>(allocationCount - allocationsBefore));
+        }
+    }
+
+    // runs the frames of a phase until frameCount frames are measured, repeating the script as needed
+    FrameSamples RunPhase(ImGui::FileBrowser &browser, const std::vector<ScriptedFrame> &script, int frameCount)
+    {
+        FrameSamples samples;
+        samples.milliseconds.reserve(static_cast<size_t>(frameCount));
+        samples.allocations.reserve(static_cast<size_t>(frameCount));
+        for(int i = 0; i < frameCount; ++i)
+        {
+            RunFrame(browser, script[static_cast<size_t>(i) % script.size()], &samples);
+        }
+        return samples;
+    }
+
+    void AddPhase(
+        bench::JsonResults &results, const std::string &name, size_t entryCount, const FrameSamples &samples,
+        std::vector<std::pair<std::string, double>> extraFields = {})
+    {
+        double allocationSum = 0;
+        for(const double allocations : samples.allocations)
+        {
+            allocationSum += allocations;
+        }
+
+        std::vector<std::pair<std::string, double>> fields = {
+            { "entries",               static_cast<double>(entryCount) },
+            { "frames",                static_cast<double>(samples.milliseconds.size()) },
+            { "p50_ms",                bench::Percentile(samples.milliseconds, 50) },
+            { "p99_ms",                bench::Percentile(samples.milliseconds, 99) },
+            { "max_ms",                *std::max_element(samples.milliseconds.begin(), samples.milliseconds.end()) },
+            { "allocations_per_frame", allocationSum / static_cast<double>(samples.allocations.size()) },
+            { "allocations_p99",       bench::Percentile(samples.allocations, 99) } };
+        fields.insert(fields.end(), extraFields.begin(), extraFields.end());
+        results.Add(name, fields);
+    }
+
+    ScriptedFrame MoveMouse(ImVec2 pos)
+    {
+        return { [pos](ImGuiIO &io) { io.AddMousePosEvent(pos.x, pos.y); }, nullptr };
+    }
+
+    ScriptedFrame SetMouseButton(bool down)
+    {
+        return { [down](ImGuiIO &io) { io.AddMouseButtonEvent(ImGuiMouseButton_Left, down); }, nullptr };
+    }
+
+    ScriptedFrame SetKeys(std::vector<ImGuiKey> keys, bool down)
+    {
+        return { [keys = std::move(keys), down](ImGuiIO &io)
+        {
+            for(const ImGuiKey key : keys)
+            {
+                io.AddKeyEvent(key, down);
+            }
+        }, nullptr };
+    }
+
+    // center of the button of the given section of the current path, in the row below the title bar. mirrors the
+    // layout of FileBrowser::Display on posix systems with the default style: '<' and '>' buttons, then one small
+    // button per section
+    ImVec2 GetPathButtonCenter(const std::filesystem::path &currentDir, ptrdiff_t sectionIndex)
+    {
+        const ImGuiStyle &style = ImGui::GetStyle();
+        auto buttonWidth = [&](const std::string &label)
+        {
+            return ImGui::CalcTextSize(label.c_str()).x + 2 * style.FramePadding.x;
+        };
+
+        float x = style.WindowPadding.x + buttonWidth("<") + style.ItemSpacing.x + buttonWidth(">") +
+                  style.ItemSpacing.x;
+        ptrdiff_t index = 0;
+        for(auto &section : currentDir)
+        {
+            const float width = buttonWidth(section.u8string());
+            if(index++ == sectionIndex)
+            {
+                x += width / 2;
+                break;
+            }
+            x += width + style.ItemSpacing.x;
+        }
+
+        const float titleBarHeight = ImGui::GetFontSize() + 2 * style.FramePadding.y;
+        return ImVec2(x, titleBarHeight + style.WindowPadding.y + ImGui::GetFontSize() / 2);
+    }
+
+    void MeasureFrames(const std::filesystem::path &dir, size_t entryCount, int frameCount, bench::JsonResults &results)
+    {
+        HeadlessContext context;
+
+        // directories are selectable so that the rows at the top of the list can be range selected
+        ImGui::FileBrowser browser(
+            ImGuiFileBrowserFlags_MultipleSelection | ImGuiFileBrowserFlags_SelectDirectory |
+            ImGuiFileBrowserFlags_ShowDetails, dir);
+        browser.SetWindowPos(0, 0);
+        browser.SetWindowSize(static_cast<int>(DISPLAY_WIDTH), static_cast<int>(DISPLAY_HEIGHT));
+        browser.SetNavigationDebounceTime(std::chrono::milliseconds(0));
+        browser.SetTypeFilters(TYPE_FILTERS);
+        browser.Open();
+
+        // let the popup appear and the first metadata requests finish before measuring
+        for(int i = 0; i < 10; ++i)
+        {
+            RunFrame(browser, {}, nullptr);
+        }
+
+        AddPhase(results, "idle", entryCount, RunPhase(browser, { ScriptedFrame{} }, frameCount));
+
+        // click a row, then shift-click a row further down and release shift. repeated with the mouse button
+        // pressed and released in separate frames, as input events are applied one per frame anyway
+        const std::vector<ScriptedFrame> rangeSelectScript = {
+            MoveMouse(FIRST_CLICK_POS), SetMouseButton(true), SetMouseButton(false),
+            SetKeys({ ImGuiMod_Shift, ImGuiKey_LeftShift }, true), MoveMouse(RANGE_CLICK_POS),
+            SetMouseButton(true), SetMouseButton(false), SetKeys({ ImGuiMod_Shift, ImGuiKey_LeftShift }, false) };
+        const FrameSamples rangeSelectSamples = RunPhase(
+            browser, rangeSelectScript, static_cast<int>(rangeSelectScript.size()) * (frameCount / 8 + 1));
+        AddPhase(results, "range_select", entryCount, rangeSelectSamples,
+                 { { "selected", static_cast<double>(browser.GetMultiSelected().size()) } });
+
+        const std::vector<ScriptedFrame> selectAllScript = {
+            SetKeys({ ImGuiMod_Ctrl, ImGuiKey_LeftCtrl }, true), SetKeys({ ImGuiKey_A }, true),
+            SetKeys({ ImGuiKey_A }, false), SetKeys({ ImGuiMod_Ctrl, ImGuiKey_LeftCtrl }, false) };
+        const FrameSamples selectAllSamples = RunPhase(browser, selectAllScript, frameCount);
+        AddPhase(results, "select_all", entryCount, selectAllSamples,
+                 { { "selected", static_cast<double>(browser.GetMultiSelected().size()) } });
+
+        // scroll down through the list, one wheel notch per frame
+        const FrameSamples scrollSamples = RunPhase(browser, {
+            { [](ImGuiIO &io)
+            {
+                io.AddMousePosEvent(FIRST_CLICK_POS.x, FIRST_CLICK_POS.y);
+                io.AddMouseWheelEvent(0, -1);
+            }, nullptr } }, frameCount);
+        AddPhase(results, "scroll", entryCount, scrollSamples);
+
+        std::vector<ScriptedFrame> typeFilterScript;
+        for(size_t i = 0; i < TYPE_FILTERS.size(); ++i)
+        {
+            typeFilterScript.push_back({ nullptr, [i](ImGui::FileBrowser &b)
+            {
+                b.SetCurrentTypeFilterIndex(static_cast<int>(i));
+            } });
+        }
+        AddPhase(results, "switch_type_filter", entryCount, RunPhase(browser, typeFilterScript, frameCount));
+
+        // enter a nested directory, then go back to the large one with alt+left
+        const std::vector<std::string> names = bench::GenerateNames(entryCount, static_cast<uint32_t>(entryCount));
+        const std::filesystem::path nestedDir = dir / std::filesystem::u8path(names[0]) / "level0" / "level1";
+        const std::filesystem::path startDir = browser.GetPwd();
+        const std::vector<ScriptedFrame> navigationScript = {
+            { nullptr, [nestedDir](ImGui::FileBrowser &b) { b.SetDirectory(nestedDir); } },
+            SetKeys({ ImGuiMod_Alt, ImGuiKey_LeftAlt, ImGuiKey_LeftArrow }, true),
+            SetKeys({ ImGuiMod_Alt, ImGuiKey_LeftAlt, ImGuiKey_LeftArrow }, false) };
+        const FrameSamples navigationSamples = RunPhase(
+            browser, navigationScript, static_cast<int>(navigationScript.size()) * (frameCount / 3 + 1));
+        AddPhase(results, "navigate_back", entryCount, navigationSamples,
+                 { { "back_in_start_directory", browser.GetPwd() == startDir ? 1.0 : 0.0 } });
+
+        // enter the nested directory, then click the button of the large one in the current path. the path of the
+        // large one is a prefix of the nested one, so the button is at the same place as its last section
+        const ImVec2 breadcrumbPos = GetPathButtonCenter(
+            startDir, std::distance(startDir.begin(), startDir.end()) - 1);
+        const std::vector<ScriptedFrame> breadcrumbScript = {
+            { nullptr, [nestedDir](ImGui::FileBrowser &b) { b.SetDirectory(nestedDir); } },
+            MoveMouse(breadcrumbPos), SetMouseButton(true), SetMouseButton(false) };
+        const FrameSamples breadcrumbSamples = RunPhase(
+            browser, breadcrumbScript, static_cast<int>(breadcrumbScript.size()) * (frameCount / 4 + 1));
+        AddPhase(results, "navigate_breadcrumb", entryCount, breadcrumbSamples,
+                 { { "back_in_start_directory", browser.GetPwd() == startDir ? 1.0 : 0.0 } });
+
+        browser.Close();
+        RunFrame(browser, {}, nullptr);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench::CommandLine commandLine;
+    commandLine.sizes = { 100000 };
+    if(!commandLine.Parse(argc, argv))
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " [--sizes 100000] [--frames 300] [--output results.json] [--label text]\n";
+        return 1;
+    }
+
+    bench::JsonResults results("imfilebrowser_frame", commandLine.label);
+    bench::TempDirectory root("imfilebrowser_frame_bench");
+    for(const size_t size : commandLine.sizes)
+    {
+        const std::filesystem::path dir = root.GetPath() / ("entries_" + std::to_string(size));
+        bench::CreateTree(dir, size);
+        MeasureFrames(dir, size, commandLine.frameCount, results);
+        std::filesystem::remove_all(dir);
+    }
+
+    if(!results.Write(commandLine.output))
+    {
+        std::cerr << "failed to write " << commandLine.output << "\n";
+        return 1;
+    }
+    return 0;
+}
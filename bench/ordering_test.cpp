@@ -0,0 +1,158 @@
+// checks the order in which records are listed: directories first, names compared case-insensitively with
+// non-ascii names after ascii ones, and ties broken the same way whatever the input order was.
+// returns nonzero if any check fails
+
+#include "bench_common.h"
+
+using Internals = ImGui::FileBrowserInternals;
+
+namespace
+{
+    struct Entry
+    {
+        bool        isDir;
+        std::string name;
+    };
+
+    int failureCount = 0;
+
+    // chunkCount > 1 sorts chunks in parallel and merges them
+    std::vector<std::string> Sort(const std::vector<Entry> &entries, bool naturalOrder, size_t chunkCount = 1)
+    {
+        Internals::FileRecordTable records(naturalOrder);
+        records.Add(true, "..");
+        for(auto &entry : entries)
+        {
+            records.Add(entry.isDir, entry.name);
+        }
+        Internals::SortFileRecordsInChunks(records, chunkCount);
+
+        std::vector<std::string> names;
+        for(size_t i = 1; i < records.Size(); ++i)
+        {
+            names.emplace_back(records.GetName(i));
+        }
+        return names;
+    }
+
+    std::string Join(const std::vector<std::string> &names)
+    {
+        std::string result;
+        for(auto &name : names)
+        {
+            result += (result.empty() ? "" : ", ") + name;
+        }
+        return "[" + result + "]";
+    }
+
+    // sorts entries in the given order and reversed, and compares both results with expected
+    void CheckOrder(
+        const char *title, const std::vector<Entry> &entries, const std::vector<std::string> &expected,
+        bool naturalOrder = false)
+    {
+        const std::vector<Entry> reversedEntries(entries.rbegin(), entries.rend());
+        for(auto *input : { &entries, &reversedEntries })
+        {
+            const std::vector<std::string> names = Sort(*input, naturalOrder);
+            if(names != expected)
+            {
+                std::cerr << "FAILED " << title << ": expected " << Join(expected) << ", got " << Join(names) << "\n";
+                ++failureCount;
+                return;
+            }
+        }
+    }
+
+    std::vector<Entry> Files(const std::vector<std::string> &names)
+    {
+        std::vector<Entry> entries;
+        for(auto &name : names)
+        {
+            entries.push_back({ false, name });
+        }
+        return entries;
+    }
+
+    // the parallel sort merges sorted chunks and must give the same order as sorting everything at once.
+    // the chunk count is given explicitly, so the merge is checked on a single hardware thread too
+    void CheckParallelSort(size_t entryCount, size_t chunkCount, bool naturalOrder)
+    {
+        std::vector<Entry> entries = Files(bench::GenerateNames(entryCount, 1));
+        for(size_t i = 0; i < entries.size(); i += 10)
+        {
+            entries[i].isDir = true;
+        }
+
+        if(Sort(entries, naturalOrder, chunkCount) != Sort(entries, naturalOrder))
+        {
+            std::cerr << "FAILED parallel sort of " << entryCount << " entries in " << chunkCount << " chunks"
+                      << (naturalOrder ? " in natural order" : "") << "\n";
+            ++failureCount;
+        }
+    }
+} // namespace
+
+int main()
+{
+    CheckOrder("directories first",
+               { { false, "a.txt" }, { true, "b" }, { false, "0" }, { true, "Z" }, { true, "a" } },
+               { "a", "b", "Z", "0", "a.txt" });
+
+    CheckOrder("case-insensitive",
+               Files({ "banana", "Apple", "cherry", "apricot" }),
+               { "Apple", "apricot", "banana", "cherry" });
+
+    CheckOrder("case ties, lower case first",
+               Files({ "ABC", "abc", "Abc" }),
+               { "abc", "Abc", "ABC" });
+
+    // before case-insensitive keys, names were ordered by comparing case-ranked letters, which put a1 before A0
+    CheckOrder("case does not outweigh later characters",
+               Files({ "a1", "A0" }),
+               { "A0", "a1" });
+
+    CheckOrder("case ties only break ties",
+               Files({ "b0", "a0", "A1" }),
+               { "a0", "A1", "b0" });
+
+    // longer than 16 bytes, so that the vectorized part of building keys is used
+    CheckOrder("long names",
+               Files({ "Long_File_Name_With_Upper_Case_2", "long_file_name_with_upper_case_1",
+                       "LONG_FILE_NAME_WITH_UPPER_CASE_1" }),
+               { "long_file_name_with_upper_case_1", "LONG_FILE_NAME_WITH_UPPER_CASE_1",
+                 "Long_File_Name_With_Upper_Case_2" });
+
+    CheckOrder("non-ascii after ascii",
+               Files({ "\xC3\xA9tude", "zeta", "\xCE\xA9mega", "alpha", "~tilde" }),
+               { "alpha", "zeta", "~tilde", "\xC3\xA9tude", "\xCE\xA9mega" });
+
+    // "Étude" and "étude" only differ in case
+    CheckOrder("non-ascii case-insensitive",
+               Files({ "\xC3\xA9tude", "\xC3\x89tude", "\xC3\x89z", "\xC3\xA9s" }),
+               { "\xC3\xA9s", "\xC3\x89tude", "\xC3\xA9tude", "\xC3\x89z" });
+
+    CheckOrder("digits without natural order",
+               Files({ "img100", "img20", "img3" }),
+               { "img100", "img20", "img3" });
+
+    CheckOrder("natural order",
+               Files({ "img100", "img20", "img3", "IMG20" }),
+               { "img3", "img20", "IMG20", "img100" }, true);
+
+    CheckOrder("natural order leading zeros",
+               Files({ "img7", "img007", "img07", "img8" }),
+               { "img007", "img07", "img7", "img8" }, true);
+
+    CheckParallelSort(100000, 2, false);
+    CheckParallelSort(100000, 7, true);
+    // more chunks than records
+    CheckParallelSort(5, 8, false);
+
+    if(failureCount)
+    {
+        std::cerr << failureCount << " check(s) failed\n";
+        return 1;
+    }
+    std::cerr << "all checks passed\n";
+    return 0;
+}
@@ -2,14 +2,51 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <set>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/inotify.h>
+#endif
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// define IMGUI_FILEBROWSER_DISABLE_SIMD to use the portable implementation of name searching
+#if !defined(IMGUI_FILEBROWSER_DISABLE_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_FILEBROWSER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifndef IMGUI_VERSION
 #   error "include imgui.h before this header"
 #endif
@@ -31,10 +68,109 @@ enum ImGuiFileBrowserFlags_ : std::uint32_t
     ImGuiFileBrowserFlags_SkipItemsCausingError = 1 << 10, // when entering a new directory, any error will interrupt the process, causing the file browser to fall back to the working directory.
                                                            // with this flag, if an error is caused by a specific item in the directory, that item will be skipped, allowing the process to continue.
     ImGuiFileBrowserFlags_EditPathString        = 1 << 11, // allow user to directly edit the whole path string
+    ImGuiFileBrowserFlags_AsyncEnumeration      = 1 << 12, // enumerate directory entries on a background thread instead of blocking the frame
+    ImGuiFileBrowserFlags_WatchDirectory        = 1 << 13, // keep the listing up to date with changes made by other programs. uses inotify on linux and polls the directory elsewhere
+    ImGuiFileBrowserFlags_ShowStats             = 1 << 14, // show enumeration and frame timings in the status bar
+    ImGuiFileBrowserFlags_IgnoreTypeFilterCase  = 1 << 15, // match type filters case-insensitively. always enabled on windows
+    ImGuiFileBrowserFlags_SearchBox             = 1 << 16, // show a search box above the file list, narrowing it to entries whose names contain the query
+    ImGuiFileBrowserFlags_ShowDetails           = 1 << 17, // show the file list as a table with size, modification time and type columns. metadata is fetched in the background
+    ImGuiFileBrowserFlags_NaturalOrder          = 1 << 18, // compare digit sequences in names by their numeric values, so that 'file2' comes before 'file10'
+    ImGuiFileBrowserFlags_PrefetchDirectories   = 1 << 19, // enumerate hovered directories in the background and put them into the listing cache, so that entering them is instant
+    ImGuiFileBrowserFlags_RecursiveSearch       = 1 << 20, // show a checkbox next to the search box to search all subdirectories of current directory. requires ImGuiFileBrowserFlags_SearchBox
+    ImGuiFileBrowserFlags_DirectorySizes        = 1 << 21, // calculate total sizes of subdirectories in the background and show them in the size column. requires ImGuiFileBrowserFlags_ShowDetails. totals are cached by the modification time of each subdirectory, which misses changes deeper inside until refreshed or a change in current directory is watched
+    ImGuiFileBrowserFlags_ShowPreview           = 1 << 22, // show a pane next to the file list with the size and the beginning of the focused or selected file, as text or a hex dump
+    ImGuiFileBrowserFlags_SharedListingCache    = 1 << 23, // keep listings in a cache shared by all file browsers with this flag, so that browsers showing the same directory share its listing
 };
 
+// internal phases of the file browser are wrapped in IMGUI_FILEBROWSER_TRACE_SCOPE(name), which compiles to nothing
+// by default. to show them on a profiler timeline, either
+//   - define IMGUI_FILEBROWSER_TRACE_SCOPE before including this header, eg. as ZoneScopedN(name) for tracy, or
+//   - define IMGUI_FILEBROWSER_ENABLE_TRACE and pass a callback to ImGui::SetFileBrowserTraceCallback.
+//     ImGui::FileBrowserChromeTraceWriter is a ready-made callback writing a chrome trace event file
+#ifndef IMGUI_FILEBROWSER_TRACE_SCOPE
+#   ifdef IMGUI_FILEBROWSER_ENABLE_TRACE
+#       define IMGUI_FILEBROWSER_TRACE_CONCAT_IMPL(a, b) a##b
+#       define IMGUI_FILEBROWSER_TRACE_CONCAT(a, b) IMGUI_FILEBROWSER_TRACE_CONCAT_IMPL(a, b)
+#       define IMGUI_FILEBROWSER_TRACE_SCOPE(name) \
+            const ImGui::FileBrowserTraceScope IMGUI_FILEBROWSER_TRACE_CONCAT(imFileBrowserTraceScope, __LINE__)(name)
+#   else
+#       define IMGUI_FILEBROWSER_TRACE_SCOPE(name) ((void)0)
+#   endif
+#endif
+
+#ifdef IMGUI_FILEBROWSER_ENABLE_TRACE
+
+#include <fstream>
+
+namespace ImGui
+{
+    // called with isBegin = true when a traced scope is entered and with isBegin = false when it is left.
+    // name is a string literal. may be called from background threads
+    using FileBrowserTraceCallback = void (*)(const char *name, bool isBegin, void *userData);
+
+    // set the callback receiving the scopes of all file browsers. pass nullptr to stop tracing.
+    // should not be changed while a file browser is enumerating a directory in the background
+    void SetFileBrowserTraceCallback(FileBrowserTraceCallback callback, void *userData = nullptr);
+
+    class FileBrowserTraceScope
+    {
+    public:
+
+        explicit FileBrowserTraceScope(const char *name);
+
+        FileBrowserTraceScope(const FileBrowserTraceScope &) = delete;
+
+        FileBrowserTraceScope &operator=(const FileBrowserTraceScope &) = delete;
+
+        ~FileBrowserTraceScope();
+
+    private:
+
+        const char *name_;
+    };
+
+    // writes received scopes to a file in the chrome trace event format, which can be loaded
+    // in chrome://tracing or https://ui.perfetto.dev. usage:
+    //     ImGui::FileBrowserChromeTraceWriter writer("trace.json");
+    //     ImGui::SetFileBrowserTraceCallback(ImGui::FileBrowserChromeTraceWriter::Callback, &writer);
+    //     ...
+    //     ImGui::SetFileBrowserTraceCallback(nullptr);
+    class FileBrowserChromeTraceWriter
+    {
+    public:
+
+        explicit FileBrowserChromeTraceWriter(const std::filesystem::path &filename);
+
+        FileBrowserChromeTraceWriter(const FileBrowserChromeTraceWriter &) = delete;
+
+        FileBrowserChromeTraceWriter &operator=(const FileBrowserChromeTraceWriter &) = delete;
+
+        // finish the file. the writer must not be used as the trace callback anymore
+        ~FileBrowserChromeTraceWriter();
+
+        bool IsOpened() const noexcept;
+
+        static void Callback(const char *name, bool isBegin, void *userData);
+
+    private:
+
+        void Write(const char *name, bool isBegin);
+
+        std::mutex                            mutex_;
+        std::ofstream                         file_;
+        std::chrono::steady_clock::time_point startTime_;
+        std::vector<std::thread::id>          threadIds_; // index + 1 is used as the tid of events
+        bool                                  isFirstEvent_;
+    };
+} // namespace ImGui
+
+#endif // #ifdef IMGUI_FILEBROWSER_ENABLE_TRACE
+
 namespace ImGui
 {
+    // defined by the benchmarks and tests in bench/ to reach the internals of FileBrowser
+    struct FileBrowserInternals;
+
     class FileBrowser
     {
     public:
@@ -47,6 +183,8 @@ namespace ImGui
 
         FileBrowser &operator=(const FileBrowser &copyFrom);
 
+        ~FileBrowser();
+
         // set the window position (in pixels)
         // default is centered
         void SetWindowPos(int posX, int posY) noexcept;
@@ -73,6 +211,10 @@ namespace ImGui
         // returns true when there is a selected filename
         bool HasSelected() const noexcept;
 
+        // returns true when ImGuiFileBrowserFlags_AsyncEnumeration is enabled
+        // and the current directory is still being enumerated
+        bool IsLoading() const noexcept;
+
         // set current browsing directory
         bool SetDirectory(const std::filesystem::path &dir = std::filesystem::current_path());
 
@@ -106,6 +248,9 @@ namespace ImGui
 
         // (optional) set file type filters. eg. { ".h", ".cpp", ".hpp" }
         // ".*" matches any file types
+        // filters with more than one dot match the end of filenames. eg. ".tar.gz"
+        // filters containing '*' or '?' are glob patterns matching whole filenames. eg. "*_test.cpp"
+        // other filters not starting with a dot match whole filenames. eg. "Makefile"
         void SetTypeFilters(const std::vector<std::string> &typeFilters);
 
         // set currently applied type filter
@@ -116,8 +261,77 @@ namespace ImGui
         // this function will pre-fill the input dialog with a filename.
         void SetInputName(std::string_view input);
 
+        // returns approximate number of bytes used to store the entries of current directory
+        size_t GetMemoryUsage() const noexcept;
+
+        // directories containing at least this many entries are sorted with multiple threads, one chunk per hardware
+        // thread and at least 8192 entries per chunk. disabled by default. see sort_parallel in
+        // imfilebrowser_enumeration_bench for the speedup on a machine. threads are started for each sort rather
+        // than kept in a pool, which costs little next to sorting that many entries
+        void SetParallelSortThreshold(size_t threshold) noexcept;
+
+        struct RefreshStats
+        {
+            size_t addedCount   = 0;
+            size_t removedCount = 0;
+            size_t keptCount    = 0;
+        };
+
+        // returns how many entries were added, removed and kept by the last refresh of current directory
+        const RefreshStats &GetLastRefreshStats() const noexcept;
+
+        struct Stats
+        {
+            size_t scannedEntryCount  = 0; // entries returned by the directory iterator in the last enumeration
+            size_t skippedEntryCount  = 0; // entries skipped because of errors. see ImGuiFileBrowserFlags_SkipItemsCausingError
+            double enumerationMs      = 0; // time of iterating the directory in the last enumeration
+            double sortMs             = 0; // time of sorting the records in the last enumeration
+            double filterMs           = 0; // time of matching type filters when the visible records were last rebuilt
+            size_t recordCount        = 0; // entries of current directory
+            size_t visibleRecordCount = 0; // entries passing the type filters
+            size_t drawnRowCount      = 0; // rows drawn in the last frame
+            size_t selectedCount      = 0;
+            size_t memoryUsage        = 0; // see GetMemoryUsage
+            double frameMs            = 0; // time spent in the last Display() call while opened
+            double frameMsP50         = 0; // median of recent frame times
+            double frameMsP99         = 0;
+        };
+
+        // returns counters and timings of the last enumeration and the last frames
+        Stats GetStats() const;
+
+        // set the budget of the cache holding listings of recently visited directories
+        // default is 16 listings and 64 MiB in total. set maxEntries to 0 to disable the cache
+        void SetListingCacheCapacity(size_t maxEntries, size_t maxBytes);
+
+        // with ImGuiFileBrowserFlags_AsyncEnumeration, directory changes following the previous one within this time
+        // are delayed until no more changes come in, so that only the last of rapid successive changes is enumerated.
+        // synchronous enumeration is never delayed. default is 150 ms. 0 disables the delay
+        void SetNavigationDebounceTime(std::chrono::milliseconds time) noexcept;
+
+        struct RecursiveSearchOptions
+        {
+            int                      maxDepth            = 32;     // levels of subdirectories below current directory
+            size_t                   maxResultCount      = 100000; // the search stops when this many entries are found
+            bool                     followSymlinks      = true;   // each symlinked directory outside current directory is searched at most once
+            std::vector<std::string> excludedDirectories = { ".git", ".svn", ".hg", "node_modules" }; // names of directories not searched
+        };
+
+        // set the limits of searching subdirectories. see ImGuiFileBrowserFlags_RecursiveSearch
+        void SetRecursiveSearchOptions(RecursiveSearchOptions options);
+
+        // set how many recent previews are cached and how many bytes of each file are read for its preview
+        // default is 32 previews of at most 1 KiB. see ImGuiFileBrowserFlags_ShowPreview
+        void SetPreviewCacheCapacity(size_t maxEntries, size_t maxBytesPerFile);
+
+        // set the budget of the listing cache used by all file browsers with ImGuiFileBrowserFlags_SharedListingCache
+        // default is 64 listings and 256 MiB in total. set maxEntries to 0 to disable the cache
+        static void SetSharedListingCacheCapacity(size_t maxEntries, size_t maxBytes);
+
     private:
 
+        friend struct FileBrowserInternals;
+
         template <class Functor>
         struct ScopeGuard
         {
@@ -130,1094 +344,5804 @@ namespace ImGui
             Functor func;
         };
 
-        struct FileRecord
+        // file records stored as structure of arrays. names of all records are packed into a single
+        // utf-8 string pool, each followed by '\0' so that it can be passed to imgui without copying,
+        // and then by its collation key. copies of a table share the arrays until one of them is modified
+        class FileRecordTable
         {
-            bool                  isDir = false;
-            std::filesystem::path name;
-            std::string           showName;
-            std::filesystem::path extension;
-        };
+        public:
 
-        static std::string ToLower(const std::string &s);
+            explicit FileRecordTable(bool naturalOrder = false) : naturalOrder_(naturalOrder) { }
 
-        void ToolTip(const std::string_view &s);
+            size_t Size() const noexcept { return storage_ ? storage_->nameOffsets.size() : 0; }
 
-        void UpdateFileRecords();
+            bool IsNaturalOrder() const noexcept { return naturalOrder_; }
 
-        void SetCurrentDirectoryUncatched(const std::filesystem::path &pwd);
+            bool IsDir(size_t i) const noexcept { return storage_->recordFlags[i] & RecordFlag_Dir; }
 
-        bool SetCurrentDirectoryInternal(
-            const std::filesystem::path &dir,
-            const std::filesystem::path &preferredFallback);
+            const char *GetNameCStr(size_t i) const noexcept
+            {
+                return storage_->pool.data() + storage_->nameOffsets[i];
+            }
 
-        bool IsExtensionMatched(const std::filesystem::path &extension) const;
+            std::string_view GetName(size_t i) const noexcept
+            {
+                return std::string_view(GetNameCStr(i), storage_->nameLengths[i]);
+            }
 
-        void ClearRangeSelectionState();
+            // extension is always a suffix of the name
+            std::string_view GetExtension(size_t i) const noexcept
+            {
+                return GetName(i).substr(storage_->extensionOffsets[i]);
+            }
 
-        static void AssignToArrayStyleString(std::vector<char> &arr, std::string_view content);
+            // names of recursive search results are paths relative to current directory, separated by '/'
+            std::string_view GetFileName(size_t i) const noexcept
+            {
+                const std::string_view name = GetName(i);
+                return name.substr(name.rfind('/') + 1);
+            }
 
-        static int ExpandInputBuffer(ImGuiInputTextCallbackData *callbackData);
+            // computed once when the record is added. see AppendCollationKey
+            std::string_view GetCollationKey(size_t i) const noexcept
+            {
+                return std::string_view(GetNameCStr(i) + storage_->nameLengths[i] + 1, storage_->keyLengths[i]);
+            }
 
-#ifdef _WIN32
-        static std::uint32_t GetDrivesBitMask();
-#endif
+            // append a key of name to out, so that comparing keys bytewise orders names case-insensitively.
+            // utf-8 is decoded and simply case-folded, and digit sequences are compared by value if naturalOrder is true
+            static void AppendCollationKey(std::string &out, std::string_view name, bool naturalOrder);
 
-        // for c++17 compatibility
+            void Clear();
 
-#if defined(__cpp_lib_char8_t)
-        static std::string u8StrToStr(std::u8string s);
-#endif
-        static std::string u8StrToStr(std::string s);
+            void Add(bool isDir, std::string_view name);
 
-        static std::filesystem::path u8StrToPath(const char *str);
+            // insert a record at the given position
+            void Insert(size_t i, bool isDir, std::string_view name);
 
-        int width_;
-        int height_;
-        int posX_;
-        int posY_;
-        ImGuiFileBrowserFlags flags_;
-        std::filesystem::path defaultDirectory_;
+            void Erase(size_t i);
 
-        std::string title_;
-        std::string openLabel_;
+            // append records [begin, end) of another table
+            void Append(const FileRecordTable &other, size_t begin, size_t end);
 
-        bool shouldOpen_;
-        bool shouldClose_;
-        bool isOpened_;
-        bool isOk_;
-        bool isPosSet_;
+            // reorder records in place so that the i-th record becomes the old newToOld[i]-th one
+            void Permute(const std::vector<uint32_t> &newToOld);
 
-        std::string statusStr_;
+            // approximate number of heap bytes held by this table, including those shared with its copies
+            size_t GetMemoryUsage() const noexcept;
 
-        std::vector<std::string> typeFilters_;
-        unsigned int             typeFilterIndex_;
-        bool                     hasAllFilter_;
+        private:
 
-        std::filesystem::path   currentDirectory_;
-        std::vector<FileRecord> fileRecords_;
+            enum : uint8_t
+            {
+                RecordFlag_Dir = 1 << 0,
+            };
 
-        unsigned int                    rangeSelectionStart_; // enable range selection when shift is pressed
-        std::set<std::filesystem::path> selectedFilenames_;
+            struct Storage
+            {
+                std::string           pool;
+                size_t                unusedPoolBytes = 0; // bytes in pool belonging to erased records
+                std::vector<uint32_t> nameOffsets;      // offset of each name in pool
+                std::vector<uint16_t> nameLengths;      // name length in bytes, not including '\0'
+                std::vector<uint16_t> keyLengths;       // collation key length in bytes. the key follows the '\0' of the name
+                std::vector<uint16_t> extensionOffsets; // extension offset relative to the name. equals to the name length if there is no extension
+                std::vector<uint8_t>  recordFlags;      // combination of RecordFlag_XXX
+            };
 
-        std::string       openNewDirLabel_;
-        std::vector<char> newDirNameBuffer_;
-        std::vector<char> inputNameBuffer_;
-        std::string       customizedInputName_;
+            // same rule as std::filesystem::path::extension, applied to the last component of relative paths
+            static size_t GetExtensionOffset(std::string_view name) noexcept;
 
-        bool              editDir_;
-        bool              setFocusToEditDir_;
-        std::vector<char> currDirBuffer_;
+            // returns storage_ after copying it if it is shared with other tables
+            Storage &GetMutableStorage();
 
-#ifdef _WIN32
-        std::uint32_t drives_;
-#endif
-    };
-} // namespace ImGui
+            // rebuild the pool without names of erased records
+            static void CompactPool(Storage &storage);
 
-inline ImGui::FileBrowser::FileBrowser(ImGuiFileBrowserFlags flags, std::filesystem::path defaultDirectory)
-    : width_(700)
-    , height_(450)
-    , posX_(0)
-    , posY_(0)
-    , flags_(flags)
-    , defaultDirectory_(std::move(defaultDirectory))
-    , shouldOpen_(false)
-    , shouldClose_(false)
-    , isOpened_(false)
-    , isOk_(false)
-    , isPosSet_(false)
-    , rangeSelectionStart_(0)
-    , editDir_(false)
-    , setFocusToEditDir_(false)
-{
-    assert(!((flags_ & ImGuiFileBrowserFlags_SelectDirectory) && (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)) &&
-           "'EnterNewFilename' doesn't work when 'SelectDirectory' is enabled");
-    if(flags_ & ImGuiFileBrowserFlags_CreateNewDir)
-    {
-        newDirNameBuffer_.resize(32, '\0');
-    }
+            // simple case folding of the cased letters of common scripts
+            static uint32_t FoldCodePoint(uint32_t c) noexcept;
 
-    SetTitle("file browser");
-    SetDirectory(defaultDirectory_);
+            bool                     naturalOrder_;
+            std::shared_ptr<Storage> storage_; // null until the first record is added
+        };
 
-    typeFilters_.clear();
-    typeFilterIndex_ = 0;
-    hasAllFilter_ = false;
+        // dynamic bitset indexed by record
+        class RecordBitset
+        {
+        public:
 
-#ifdef _WIN32
-    drives_ = GetDrivesBitMask();
-#endif
-}
+            static constexpr size_t npos = static_cast<size_t>(-1);
 
-inline ImGui::FileBrowser::FileBrowser(const FileBrowser &copyFrom)
-    : FileBrowser()
-{
-    *this = copyFrom;
-}
+            size_t Size() const noexcept { return size_; }
 
-inline ImGui::FileBrowser &ImGui::FileBrowser::operator=(
-    const FileBrowser &copyFrom)
-{
-    width_  = copyFrom.width_;
-    height_ = copyFrom.height_;
+            bool Test(size_t i) const noexcept { return (words_[i / 64] >> (i % 64)) & 1; }
 
-    posX_ = copyFrom.posX_;
-    posY_ = copyFrom.posY_;
+            void Set(size_t i, bool value = true) noexcept
+            {
+                const uint64_t mask = uint64_t(1) << (i % 64);
+                words_[i / 64] = value ? (words_[i / 64] | mask) : (words_[i / 64] & ~mask);
+            }
 
-    flags_ = copyFrom.flags_;
-    SetTitle(copyFrom.title_);
+            // newly added bits are cleared
+            void Resize(size_t size);
 
-    shouldOpen_  = copyFrom.shouldOpen_;
-    shouldClose_ = copyFrom.shouldClose_;
-    isOpened_    = copyFrom.isOpened_;
-    isOk_        = copyFrom.isOk_;
-    isPosSet_    = copyFrom.isPosSet_;
+            // clear all bits without changing the size
+            void Reset() noexcept;
 
-    statusStr_ = "";
+            // set bits in [begin, end)
+            void SetRange(size_t begin, size_t end) noexcept;
 
-    typeFilters_     = copyFrom.typeFilters_;
-    typeFilterIndex_ = copyFrom.typeFilterIndex_;
-    hasAllFilter_    = copyFrom.hasAllFilter_;
+            // insert a cleared bit at position i, shifting the following bits
+            void Insert(size_t i);
 
-    selectedFilenames_   = copyFrom.selectedFilenames_;
-    rangeSelectionStart_ = copyFrom.rangeSelectionStart_;
+            // remove the bit at position i, shifting the following bits
+            void Erase(size_t i);
 
-    currentDirectory_ = copyFrom.currentDirectory_;
-    fileRecords_      = copyFrom.fileRecords_;
+            // keep only the bits that are also set in other, which must have the same size
+            void And(const RecordBitset &other) noexcept;
 
-    openNewDirLabel_     = copyFrom.openNewDirLabel_;
-    newDirNameBuffer_    = copyFrom.newDirNameBuffer_;
-    inputNameBuffer_     = copyFrom.inputNameBuffer_;
-    customizedInputName_ = copyFrom.customizedInputName_;
+            bool Any() const noexcept;
 
-    editDir_ = copyFrom.editDir_;
-    currDirBuffer_ = copyFrom.currDirBuffer_;
+            size_t Count() const noexcept;
 
-#ifdef _WIN32
-    drives_ = copyFrom.drives_;
-#endif
+            // returns the position of the first set bit not less than i, or npos if there is none
+            size_t FindNext(size_t i) const noexcept;
 
-    return *this;
-}
+        private:
 
-inline void ImGui::FileBrowser::SetWindowPos(int posX, int posY) noexcept
-{
-    posX_ = posX;
-    posY_ = posY;
-    isPosSet_ = true;
-}
+            size_t                size_ = 0;
+            std::vector<uint64_t> words_; // bits beyond size_ are always cleared
+        };
 
-inline void ImGui::FileBrowser::SetWindowSize(int width, int height) noexcept
-{
-    assert(width > 0 && height > 0);
-    width_  = width;
-    height_ = height;
-}
+        // type filters compiled into lookup structures. see SetTypeFilters for the syntax of filters
+        class TypeFilterMatcher
+        {
+        public:
 
-inline void ImGui::FileBrowser::SetTitle(std::string title)
-{
-    title_ = std::move(title);
+            explicit TypeFilterMatcher(bool ignoreCase = false) : ignoreCase_(ignoreCase) { }
 
-    const std::string thisPtrStr = std::to_string(reinterpret_cast<size_t>(this));
-    openLabel_ = title_ + "##filebrowser_" + thisPtrStr;
-    openNewDirLabel_ = "new dir##new_dir_" + thisPtrStr;
-}
+            void Add(std::string_view filter);
 
-inline void ImGui::FileBrowser::Open()
-{
-    UpdateFileRecords();
-    ClearSelected();
-    statusStr_ = std::string();
-    shouldOpen_ = true;
-    shouldClose_ = false;
-    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) && !customizedInputName_.empty())
-    {
-        AssignToArrayStyleString(inputNameBuffer_, customizedInputName_);
-        selectedFilenames_ = { u8StrToPath(inputNameBuffer_.data()) };
-    }
-}
+            // scratch is used to avoid allocations when called repeatedly
+            bool IsMatched(std::string_view name, std::string_view extension, std::string &scratch) const;
 
-inline void ImGui::FileBrowser::Close()
-{
-    ClearSelected();
-    statusStr_ = std::string();
-    shouldClose_ = true;
-    shouldOpen_ = false;
-}
+        private:
 
-inline bool ImGui::FileBrowser::IsOpened() const noexcept
-{
-    return isOpened_;
-}
+            // node of a trie built from reversed suffixes
+            struct SuffixTrieNode
+            {
+                std::vector<std::pair<char, uint32_t>> children;
+                bool                                   isTerminal = false;
+            };
 
-inline void ImGui::FileBrowser::Display()
-{
-    PushID(this);
-    ScopeGuard exitThis([this]
-    {
-        shouldOpen_ = false;
-        shouldClose_ = false;
-        PopID();
-    });
+            char Fold(char c) const noexcept;
 
-    if(shouldOpen_)
-    {
-        OpenPopup(openLabel_.c_str());
-    }
-    isOpened_ = false;
+            bool IsSuffixMatched(std::string_view name) const;
 
-    // open the popup window
+            bool IsGlobMatched(std::string_view pattern, std::string_view name) const;
 
-    if(shouldOpen_ && (flags_ & ImGuiFileBrowserFlags_NoModal))
+            bool                            ignoreCase_;
+            bool                            matchesAll_ = false;
+            std::unordered_set<std::string> extensions_;
+            std::unordered_set<std::string> filenames_;
+            std::vector<SuffixTrieNode>     suffixTrie_; // node 0 is the root
+            std::vector<std::string>        globs_;
+        };
+
+        // sorted listing of a previously visited directory
+        struct CachedListing
+        {
+            std::filesystem::path           directory;
+            std::filesystem::file_time_type lastWriteTime;
+            FileRecordTable                 records;
+        };
+
+        // process-wide cache for ImGuiFileBrowserFlags_SharedListingCache. listings are keyed by directory and
+        // collation. a listing taken from the cache shares its records with the cache and other browsers until
+        // one of them modifies its copy
+        class SharedListingCache
+        {
+        public:
+
+            static SharedListingCache &GetInstance();
+
+            void SetCapacity(size_t maxEntries, size_t maxBytes);
+
+            // replace the listing of the same directory and collation
+            void Put(CachedListing listing);
+
+            // copy the listing of dir with the collation of records into records
+            // returns false if there is none, or if the directory was modified since it was listed
+            bool Get(
+                const std::filesystem::path &dir, std::filesystem::file_time_type lastWriteTime, FileRecordTable &records);
+
+            bool Contains(const std::filesystem::path &dir, bool naturalOrder);
+
+        private:
+
+            // must be called with mutex_ held. evicted listings are moved into evicted, to be released
+            // after the mutex is unlocked
+            void Trim(std::list<CachedListing> &evicted);
+
+            std::mutex               mutex_;
+            std::list<CachedListing> listings_; // most recently used first
+            size_t                   maxEntries_ = 64;
+            size_t                   maxBytes_   = 256 << 20;
+        };
+
+        // watches currentDirectory_ when ImGuiFileBrowserFlags_WatchDirectory is enabled
+        struct DirectoryWatcher
+        {
+            static constexpr std::chrono::milliseconds POLL_INTERVAL{ 1000 };
+
+            ~DirectoryWatcher();
+
+            std::filesystem::path                 directory;
+            std::chrono::steady_clock::time_point nextPollTime;
+
+#ifdef __linux__
+            int inotifyFd = -1;
+            int watchDescriptor = -1;
+#endif
+        };
+
+        // counters and durations (in milliseconds) of the phases of an enumeration
+        struct EnumerationStats
+        {
+            size_t scannedCount  = 0; // entries returned by the directory iterator
+            size_t skippedCount  = 0; // entries skipped because of errors. see ImGuiFileBrowserFlags_SkipItemsCausingError
+            double enumerationMs = 0; // iterating the directory and building records
+            double sortMs        = 0;
+        };
+
+        struct RecordMetadata
+        {
+            enum State : uint8_t
+            {
+                State_Unknown,
+                State_Pending, // requested from MetadataFetcher
+                State_Ready,
+                State_Failed,
+            };
+
+            uint64_t               size         = 0; // 0 for directories
+            std::time_t            modifiedTime = 0;
+            std::filesystem::perms permissions  = std::filesystem::perms::unknown;
+            State                  state        = State_Unknown;
+        };
+
+        // state shared between the ui thread and the threads fetching metadata of records
+        struct MetadataFetcher
+        {
+            static constexpr unsigned int MAX_WORKER_COUNT = 4;
+
+            struct Request
+            {
+                uint64_t              generation;
+                uint32_t              recordIndex;
+                std::filesystem::path path;
+            };
+
+            struct Result
+            {
+                uint64_t       generation;
+                uint32_t       recordIndex;
+                RecordMetadata metadata;
+            };
+
+            MetadataFetcher();
+
+            ~MetadataFetcher();
+
+            std::vector<std::thread> workers;
+
+            std::mutex              mutex;
+            std::condition_variable condition;
+            bool                    stopped = false;
+            std::deque<Request>     requests;           // visible records not yet taken by any worker
+            std::deque<Request>     backgroundRequests; // served when requests is empty
+            std::vector<Result>     results;  // not yet picked up by the ui thread
+        };
+
+        // enumerates directories which are likely to be entered next on low-priority threads
+        struct DirectoryPrefetcher
+        {
+            static constexpr unsigned int MAX_WORKER_COUNT = 2;
+            static constexpr size_t       MAX_REQUEST_COUNT = 8; // older requests are dropped
+
+            DirectoryPrefetcher(ImGuiFileBrowserFlags browserFlags, size_t maxListingBytes);
+
+            ~DirectoryPrefetcher();
+
+            const ImGuiFileBrowserFlags flags;
+            const size_t                maxBytes; // listings larger than this are given up
+
+            std::vector<std::thread> workers;
+            std::atomic<bool>        stopped = false;
+
+            std::mutex                         mutex;
+            std::condition_variable            condition;
+            std::deque<std::filesystem::path>  requests; // most recent last
+            std::vector<std::filesystem::path> inProgress;
+            std::vector<CachedListing>         results;  // not yet picked up by the ui thread
+        };
+
+        // total sizes of the subdirectories of current directory being calculated by DirectorySizeCalculator
+        struct DirectorySizeJob
+        {
+            struct Root
+            {
+                std::filesystem::path           path;
+                std::string                     identity;      // see GetDirectoryIdentity. set when the root itself is walked
+                std::filesystem::file_time_type lastWriteTime;
+                std::atomic<uint64_t>           size         = 0; // partial total until isDone is set
+                std::atomic<size_t>             pendingCount = 1; // directories of the subtree queued or being walked
+                std::atomic<bool>               isDone       = false;
+                std::atomic<bool>               hasErrors    = false; // some directory of the subtree couldn't be fully walked
+            };
+
+            explicit DirectorySizeJob(size_t rootCount) : roots(rootCount), pendingRootCount(rootCount) { }
+
+            std::vector<Root>   roots; // records are sorted with directories first, so roots[i] is record i + 1
+            std::atomic<size_t> pendingRootCount;
+            std::atomic<bool>   cancelled = false;
+        };
+
+        // threads walking subtrees for ImGuiFileBrowserFlags_DirectorySizes
+        struct DirectorySizeCalculator
+        {
+            static constexpr unsigned int MAX_WORKER_COUNT = 4;
+            static constexpr size_t       MAX_CACHE_SIZE   = 65536; // least recently used totals are evicted beyond this
+
+            struct Task
+            {
+                std::shared_ptr<DirectorySizeJob> job;
+                size_t                            rootIndex;
+                std::filesystem::path             directory; // empty for the root itself
+            };
+
+            struct CachedSize
+            {
+                std::filesystem::file_time_type  lastWriteTime;
+                uint64_t                         size = 0;
+                std::list<std::string>::iterator order; // position in cacheOrder
+            };
+
+            DirectorySizeCalculator();
+
+            ~DirectorySizeCalculator();
+
+            std::vector<std::thread> workers;
+            bool                     stopped = false;
+
+            std::mutex                                  mutex;
+            std::condition_variable                     condition;
+            std::deque<Task>                            tasks; // taken from the back, so that subtrees are walked depth-first
+            std::unordered_map<std::string, CachedSize> cache; // totals of walked roots. keyed by GetDirectoryIdentity
+            std::list<std::string>                      cacheOrder; // keys of cache. most recently used first
+        };
+
+        struct FilePreview
+        {
+            std::filesystem::path           path;
+            std::filesystem::file_time_type lastWriteTime;
+            uint64_t                        size = 0;
+            bool                            isText = false;
+            std::string                     contents; // beginning of the file, or its hex dump if it is not text
+            std::string                     error;
+        };
+
+        // reads previews of files on a background thread for ImGuiFileBrowserFlags_ShowPreview
+        struct PreviewLoader
+        {
+            PreviewLoader(size_t cacheCapacity, size_t maxFileBytes);
+
+            ~PreviewLoader();
+
+            const size_t maxEntries;
+            const size_t maxBytesPerFile;
+
+            std::thread worker;
+
+            std::mutex                   mutex;
+            std::condition_variable      condition;
+            bool                         stopped = false;
+            std::filesystem::path        request; // only the latest one is kept. empty when nothing is requested
+            std::unique_ptr<FilePreview> result;  // not yet picked up by the ui thread
+
+            std::list<FilePreview> cache; // only accessed by the worker. most recently used first
+        };
+
+        // parameters of a recursive search, owned by its background thread
+        struct RecursiveSearch
+        {
+            struct Task
+            {
+                std::filesystem::path directory;
+                std::string           relativePath; // of directory, ending with '/' unless empty
+                int                   depth = 0;
+            };
+
+            // one for each worker. a worker takes tasks from the back of its own queue and steals from the front of others
+            struct TaskQueue
+            {
+                std::mutex       mutex;
+                std::deque<Task> tasks;
+            };
+
+            std::filesystem::path              root;
+            std::string                        query; // lowercase. see IsSearchMatched
+            ImGuiFileBrowserFlags              flags = 0;
+            std::unique_ptr<TypeFilterMatcher> typeFilter; // null if all files match
+            RecursiveSearchOptions             options;
+        };
+
+        // state shared between the ui thread and the background enumeration worker
+        struct AsyncEnumeration
+        {
+            static constexpr size_t BATCH_SIZE = 4096;
+
+            ~AsyncEnumeration();
+
+            std::thread       worker;
+            std::atomic<bool> cancelled = false;
+            std::atomic<bool> exited    = false; // set when the worker is about to return. joining it won't block then
+            bool              isRefresh = false; // when true, records are not streamed into staging
+
+            std::mutex         mutex;
+            FileRecordTable    staging; // newly enumerated records not yet picked up by the ui thread
+            FileRecordTable    result;  // complete sorted records. valid when finished is true
+            EnumerationStats   stats;   // valid when finished is true
+            bool               finished = false;
+            std::exception_ptr error;
+
+            // only accessed by the ui thread
+            std::filesystem::file_time_type lastWriteTime;
+        };
+
+        static std::string ToLower(const std::string &s);
+
+        static double GetMillisecondsSince(std::chrono::steady_clock::time_point start) noexcept;
+
+        void RecordFrameTime(double milliseconds) noexcept;
+
+        // returns the given percentile (in [0, 1]) of recorded frame times, or 0 if no frame is recorded
+        double GetFrameTimePercentile(double percentile) const;
+
+        void ToolTip(const std::string_view &s);
+
+        // append the record of the given entry to records. returns false if the entry is skipped
+        static bool BuildFileRecord(
+            const std::filesystem::directory_entry &entry, ImGuiFileBrowserFlags flags,
+            FileRecordTable &records, EnumerationStats &stats);
+
+        // returns true if record (lIsDir, lName) should be placed before record (rIsDir, rName)
+        static bool CompareFileRecords(
+            bool lIsDir, std::string_view lKey, std::string_view lName,
+            bool rIsDir, std::string_view rKey, std::string_view rName) noexcept;
+
+        static bool CompareFileRecords(const FileRecordTable &records, uint32_t lhs, uint32_t rhs) noexcept;
+
+        static bool CompareFileRecords(
+            const FileRecordTable &lRecords, size_t lhs, const FileRecordTable &rRecords, size_t rhs) noexcept;
+
+        // returns the first position in sorted records where the given record can be inserted
+        static size_t LowerBoundFileRecord(const FileRecordTable &records, bool isDir, std::string_view name);
+
+        // find the position of the given record in sorted records. returns records.Size() if not found
+        static size_t FindFileRecord(const FileRecordTable &records, bool isDir, std::string_view name);
+
+        // call func(chunkIndex, begin, end) for each of chunkCount disjoint chunks of [begin, end) in parallel
+        template <class Func>
+        static void ParallelForChunks(size_t begin, size_t end, size_t chunkCount, const Func &func);
+
+        static void SortFileRecords(FileRecordTable &records, size_t parallelSortThreshold);
+
+        // number of chunks SortFileRecords sorts in parallel when recordCount reaches the threshold
+        static size_t GetParallelSortChunkCount(size_t recordCount) noexcept;
+
+        // sort chunkCount chunks of records in parallel and merge them. 1 sorts on the calling thread only
+        static void SortFileRecordsInChunks(FileRecordTable &records, size_t chunkCount);
+
+        static void EnumerateFileRecordsAsync(
+            std::filesystem::directory_iterator it, ImGuiFileBrowserFlags flags,
+            size_t parallelSortThreshold, AsyncEnumeration *state);
+
+        // find matching entries in the subtree of search.root with all hardware threads. results are streamed into
+        // state->staging like EnumerateFileRecordsAsync, named by their paths relative to the root
+        static void SearchSubtree(RecursiveSearch search, size_t parallelSortThreshold, AsyncEnumeration *state);
+
+        // returns file_time_type::min() on error
+        static std::filesystem::file_time_type GetLastWriteTime(const std::filesystem::path &path) noexcept;
+
+        static void FetchRecordMetadata(MetadataFetcher *fetcher);
+
+        // let the calling background thread only run when the cpu would be idle otherwise
+        static void LowerCurrentThreadPriority() noexcept;
+
+        static void PrefetchDirectories(DirectoryPrefetcher *prefetcher);
+
+        // returns false if the enumeration was stopped or failed, or the listing exceeded the budget
+        static bool PrefetchDirectory(DirectoryPrefetcher *prefetcher, CachedListing &listing);
+
+        // queue a directory hovered by the user for prefetching
+        void RequestPrefetch(const std::filesystem::path &dir);
+
+        // move prefetched listings into the listing cache
+        void PollPrefetchedListings();
+
+        static RecordMetadata QueryRecordMetadata(const std::filesystem::path &path);
+
+        static std::time_t ToTimeT(std::filesystem::file_time_type time);
+
+        // write a human readable size like "1.5 MiB" to buffer
+        static void FormatSize(uint64_t size, char *buffer, size_t bufferSize) noexcept;
+
+        static void CalculateDirectorySizes(DirectorySizeCalculator *calculator);
+
+        // add the sizes of files directly inside the directory of task to its root, and queue its subdirectories
+        static void WalkDirectorySize(DirectorySizeCalculator *calculator, const DirectorySizeCalculator::Task &task);
+
+        // returns a string identifying the directory even after it is renamed, or an empty string on error
+        static std::string GetDirectoryIdentity(const std::filesystem::path &dir);
+
+        static void LoadPreviews(PreviewLoader *loader);
+
+        // returns the cached preview if the file hasn't changed since it was read
+        static FilePreview LoadPreview(PreviewLoader *loader, const std::filesystem::path &path);
+
+        // read at most maxBytes from the beginning of a regular file into bytes. returns false with error set on failure
+        static bool ReadFileHead(
+            const std::filesystem::path &path, size_t maxBytes, std::string &bytes, std::string &error);
+
+        // returns false if bytes contain control characters other than whitespace
+        static bool IsTextContent(std::string_view bytes) noexcept;
+
+        // 16 bytes per line, with offsets and printable characters
+        static void AppendHexDump(std::string &out, std::string_view bytes);
+
+        // draw the preview of the given file record, or a placeholder if it is out of range
+        void DrawPreview(size_t recordIndex, float reserveHeight);
+
+        // clear records and enumerate current directory. with async enumeration, when isNavigation is true and the
+        // previous navigation was within navigationDebounceTime_, the enumeration is delayed by PollPendingEnumeration
+        void UpdateFileRecords(bool isNavigation = false);
+
+        // enumerate current directory into the cleared records, on a background thread if required by flags_
+        void EnumerateFileRecords(std::filesystem::directory_iterator it, std::filesystem::file_time_type lastWriteTime);
+
+        // start enumerating current directory on a background thread. when isRefresh is true, current records stay
+        // on screen until the new listing is complete and merged into them
+        void StartAsyncEnumeration(
+            std::filesystem::directory_iterator it, bool isRefresh, std::filesystem::file_time_type lastWriteTime);
+
+        // stop the enumeration in flight and drop the delayed one. never waits for the worker
+        void CancelEnumeration();
+
+        void PollAsyncEnumeration();
+
+        // start the delayed enumeration once no navigation has happened for navigationDebounceTime_
+        void PollPendingEnumeration();
+
+        // report an error raised while enumerating current directory and fall back to the default directory
+        void HandleEnumerationError(const std::exception_ptr &error);
+
+        // schedule a recursive search for the current query if it is enabled, or go back to the listing of current
+        // directory otherwise
+        void UpdateRecursiveSearch();
+
+        // replace records with the results of searching the subtree of current directory
+        void StartRecursiveSearch();
+
+        void StopRecursiveSearch();
+
+        // re-enumerate current directory while keeping the selection. fall back to the default directory on error
+        void RefreshFileRecords();
+
+        // replace records with a newly enumerated listing of the same directory, dropping selected entries
+        // that no longer exist
+        void MergeRefreshedFileRecords(FileRecordTable &&newRecords);
+
+        // apply changes of current directory reported by inotify, or detected by polling its last write time
+        void UpdateDirectoryWatcher();
+
+        // point the watcher at currentDirectory_ if ImGuiFileBrowserFlags_WatchDirectory is enabled. called before
+        // the directory is listed, so that changes made while it is being listed are reported afterwards
+        void WatchCurrentDirectory();
+
+        // bring the record of the given entry in line with its state on disk
+        void ApplyDirectoryEntryChange(std::string_view name);
+
+        // move the complete listing of current directory into listingCache_, or into the shared listing cache
+        void CacheCurrentListing();
+
+        // take the listing of current directory from listingCache_, or from the shared listing cache,
+        // if it is still up to date
+        bool LoadCachedListing();
+
+        // put a listing into listingCache_, or into the shared listing cache
+        void StoreListing(CachedListing listing);
+
+        // make the complete listing of current directory available to other browsers sharing the listing cache
+        void ShareCurrentListing();
+
+        void TrimListingCache();
+
+        // go to the last directory in 'from' and remember current directory in 'to'
+        void NavigateHistory(
+            std::vector<std::filesystem::path> &from, std::vector<std::filesystem::path> &to);
+
+        void SetCurrentDirectoryUncatched(const std::filesystem::path &pwd);
+
+        bool SetCurrentDirectoryInternal(
+            const std::filesystem::path &dir,
+            const std::filesystem::path &preferredFallback);
+
+        // returns records matching the current type filter, or nullptr if all records match.
+        // matches are computed at most once for each record and filter
+        const RecordBitset *GetTypeFilterMatches();
+
+        // returns true if name contains all space-separated terms of the lowercase query, ignoring ascii case
+        static bool IsSearchMatched(std::string_view name, std::string_view query) noexcept;
+
+        // returns true if haystack contains the lowercase needle, ignoring ascii case. needle must not be empty
+        static bool ContainsIgnoringCase(std::string_view haystack, std::string_view needle) noexcept;
+
+        void SetSearchQuery(std::string_view query);
+
+        // returns records matching the search query, or nullptr if there is no query.
+        // matches are computed at most once for each record and query
+        const RecordBitset *GetSearchMatches();
+
+        // forget cached type filter matches, search matches and metadata after records are replaced
+        void ResetRecordCaches();
+
+        // forget fetched metadata and drop outstanding metadata requests
+        void ResetRecordMetadata();
+
+        // replace queued metadata requests with the given records, which are usually the visible ones
+        void RequestRecordMetadata(const std::vector<uint32_t> &recordIndices);
+
+        // queue all records without metadata behind the visible ones
+        void RequestAllRecordMetadata();
+
+        // apply metadata fetched by the worker threads
+        void PollRecordMetadata();
+
+        // returns true if visibleRecordIndices_ is in the natural order of records
+        bool IsViewSortedByName() const noexcept;
+
+        // returns true if record lhs should be placed before record rhs in the view sorted by sortColumn_
+        bool CompareRecordsForView(uint32_t lhs, uint32_t rhs) const;
+
+        // rank of the extension of each record among all records. built on demand
+        void UpdateExtensionRanks();
+
+        // copy the sizes of subdirectories calculated so far into directorySizeKeys_. the workers keep updating them,
+        // and std::sort requires an order that doesn't change while sorting
+        void UpdateDirectorySizeKeys();
+
+        // draw the columns after the name column of a record in the details table
+        void DrawRecordDetails(uint32_t recordIndex);
+
+        // start calculating sizes of the subdirectories once current directory is completely listed
+        void UpdateDirectorySizes();
+
+        // drop the sizes of subdirectories and stop calculating them. never waits for the workers
+        void CancelDirectorySizes();
+
+        // forget all cached totals and calculate the sizes of subdirectories again, so that changes deeper in
+        // the subtrees, which don't change the modification time of the subdirectories, are picked up
+        void RecalculateDirectorySizes();
+
+        // returns false if the size of the directory at the given record is unknown.
+        // isPartial is set while the size is still being calculated
+        bool GetDirectorySize(uint32_t recordIndex, uint64_t &size, bool &isPartial) const noexcept;
+
+        // rebuild visibleRecordIndices_ and selectableRecords_ if records, type filters or flags have changed since
+        // the last call
+        void UpdateVisibleRecordIndices();
+
+        // add the visible ones among records [begin, fileRecords_.Size()) to the end of visibleRecordIndices_
+        void AppendVisibleRecordIndices(size_t begin);
+
+        // returns true if there is any selected record or typed filename
+        bool HasAnySelection() const noexcept;
+
+        // make the record at index i the only selected one
+        void SelectSingleRecord(size_t i);
+
+        // keep the selected records selected after their indices are changed by sorting
+        void RestoreSelectionByName(const FileRecordTable &oldRecords, const RecordBitset &oldSelection);
+
+        void ClearRangeSelectionState();
+
+        static void AssignToArrayStyleString(std::vector<char> &arr, std::string_view content);
+
+        static int ExpandInputBuffer(ImGuiInputTextCallbackData *callbackData);
+
+#ifdef _WIN32
+        static std::uint32_t GetDrivesBitMask();
+#endif
+
+        // for c++17 compatibility
+
+#if defined(__cpp_lib_char8_t)
+        static std::string u8StrToStr(std::u8string s);
+#endif
+        static std::string u8StrToStr(std::string s);
+
+        static std::filesystem::path u8StrToPath(const char *str);
+
+        int width_;
+        int height_;
+        int posX_;
+        int posY_;
+        ImGuiFileBrowserFlags flags_;
+        std::filesystem::path defaultDirectory_;
+
+        std::string title_;
+        std::string openLabel_;
+
+        bool shouldOpen_;
+        bool shouldClose_;
+        bool isOpened_;
+        bool isOk_;
+        bool isPosSet_;
+
+        std::string statusStr_;
+
+        std::vector<std::string>       typeFilters_;
+        std::vector<TypeFilterMatcher> typeFilterMatchers_; // one for each entry of typeFilters_
+        std::vector<RecordBitset>      typeFilterMatches_;  // one for each entry of typeFilters_. may cover only a prefix of records
+        unsigned int                   typeFilterIndex_;
+
+        std::filesystem::path   currentDirectory_;
+        FileRecordTable         fileRecords_;
+        std::vector<uint32_t>   visibleRecordIndices_; // indices of records passing the type filters, in view order
+        bool                    visibleRecordIndicesDirty_;
+        size_t                  parallelSortThreshold_;
+
+        std::unique_ptr<AsyncEnumeration> asyncEnumeration_;
+        std::list<std::unique_ptr<AsyncEnumeration>> cancelledEnumerations_; // workers still running after being cancelled
+        RefreshStats                      lastRefreshStats_;
+        EnumerationStats                  lastEnumerationStats_;
+        double                            lastFilterMs_; // time spent matching type filters when rebuilding visibleRecordIndices_
+
+        static constexpr size_t FRAME_TIME_SAMPLE_COUNT = 256;
+
+        std::array<float, FRAME_TIME_SAMPLE_COUNT> frameTimeSamples_;     // ring buffer of Display() durations in milliseconds
+        size_t                                     frameTimeSampleCount_; // number of frames recorded in total
+        size_t                                     drawnRowCount_;        // rows drawn in the last frame
+
+        std::filesystem::file_time_type fileRecordsWriteTime_; // last write time of currentDirectory_ when it was enumerated
+        std::list<CachedListing>        listingCache_;         // most recently used first
+        size_t                          listingCacheMaxEntries_;
+        size_t                          listingCacheMaxBytes_;
+
+        std::vector<std::filesystem::path> backHistory_;
+        std::vector<std::filesystem::path> forwardHistory_;
+
+        std::chrono::milliseconds             navigationDebounceTime_;
+        std::chrono::steady_clock::time_point lastNavigationTime_;    // when the last navigation was requested or enumerated
+        bool                                  hasPendingEnumeration_; // enumeration of current directory is delayed
+        std::filesystem::directory_iterator   pendingIterator_;       // opened at the navigation so that errors trigger the fallback
+        std::filesystem::file_time_type       pendingWriteTime_;
+
+        RecursiveSearchOptions                recursiveSearchOptions_;
+        bool                                  recursiveSearch_;           // state of the checkbox next to the search box
+        bool                                  isRecursiveSearchActive_;   // records are results of a recursive search
+        bool                                  hasPendingRecursiveSearch_; // started once the query hasn't changed for navigationDebounceTime_
+        std::chrono::steady_clock::time_point lastSearchEditTime_;
+
+        std::unique_ptr<DirectoryWatcher> directoryWatcher_;
+
+        unsigned int          rangeSelectionStart_; // enable range selection when shift is pressed
+        RecordBitset          selectedRecords_;
+        RecordBitset          selectableRecords_;   // visible records which can be selected with current flags
+        std::filesystem::path selectedInputName_;   // typed filename when ImGuiFileBrowserFlags_EnterNewFilename is set. may not exist
+
+        std::string       openNewDirLabel_;
+        std::vector<char> newDirNameBuffer_;
+        std::vector<char> inputNameBuffer_;
+        std::string       customizedInputName_;
+
+        bool              editDir_;
+        bool              setFocusToEditDir_;
+        std::vector<char> currDirBuffer_;
+
+        std::vector<char> searchBuffer_;
+        std::string       searchQuery_;   // lowercase content of searchBuffer_
+        RecordBitset      searchMatches_; // may cover only a prefix of records
+
+        std::vector<RecordMetadata>      recordMetadata_;     // indexed by record. may cover only a prefix of records
+        uint64_t                         metadataGeneration_; // changed whenever record indices change, so that outdated results are dropped
+        std::unique_ptr<MetadataFetcher> metadataFetcher_;    // created on first use
+
+        std::unique_ptr<DirectoryPrefetcher> directoryPrefetcher_;  // created on first use. destroyed when the browser is closed
+        std::filesystem::path                lastPrefetchRequest_;  // the same hovered directory is requested only once
+        size_t                           backgroundMetadataRequestCount_; // records [0, count) have been queued by RequestAllRecordMetadata
+
+        enum SortColumn
+        {
+            SortColumn_Name,
+            SortColumn_Size,
+            SortColumn_Modified,
+            SortColumn_Extension,
+        };
+
+        // order of visibleRecordIndices_. records themselves always stay sorted by name
+        SortColumn                            sortColumn_;
+        bool                                  sortDescending_;
+        std::vector<uint32_t>                 extensionRanks_; // indexed by record
+        std::chrono::steady_clock::time_point lastMetadataSortTime_;
+
+        static constexpr uint64_t UNKNOWN_DIRECTORY_SIZE = static_cast<uint64_t>(-1);
+
+        std::unique_ptr<DirectorySizeCalculator> directorySizeCalculator_; // created on first use. kept while closed for its cache
+        std::shared_ptr<DirectorySizeJob>        directorySizeJob_;        // sizes of subdirectories of current directory
+        bool                                     areDirectorySizesSorted_; // the view has been sorted by complete sizes
+        std::vector<uint64_t>                    directorySizeKeys_;       // indexed by record. UNKNOWN_DIRECTORY_SIZE if not calculated yet
+
+        std::unique_ptr<PreviewLoader> previewLoader_;          // created on first use
+        std::filesystem::path          previewRequest_;         // path of the file whose preview is shown or being loaded
+        FilePreview                    preview_;                // latest preview received from previewLoader_
+        size_t                         previewMaxEntries_;
+        size_t                         previewMaxBytesPerFile_;
+
+#ifdef _WIN32
+        std::uint32_t drives_;
+#endif
+    };
+} // namespace ImGui
+
+inline ImGui::FileBrowser::FileBrowser(ImGuiFileBrowserFlags flags, std::filesystem::path defaultDirectory)
+    : width_(700)
+    , height_(450)
+    , posX_(0)
+    , posY_(0)
+    , flags_(flags)
+    , defaultDirectory_(std::move(defaultDirectory))
+    , shouldOpen_(false)
+    , shouldClose_(false)
+    , isOpened_(false)
+    , isOk_(false)
+    , isPosSet_(false)
+    , fileRecords_(flags & ImGuiFileBrowserFlags_NaturalOrder)
+    , visibleRecordIndicesDirty_(true)
+    , parallelSortThreshold_((std::numeric_limits<size_t>::max)())
+    , lastFilterMs_(0)
+    , frameTimeSamples_()
+    , frameTimeSampleCount_(0)
+    , drawnRowCount_(0)
+    , fileRecordsWriteTime_(std::filesystem::file_time_type::min())
+    , listingCacheMaxEntries_(16)
+    , listingCacheMaxBytes_(64 << 20)
+    , navigationDebounceTime_(150)
+    , hasPendingEnumeration_(false)
+    , pendingWriteTime_(std::filesystem::file_time_type::min())
+    , recursiveSearch_(false)
+    , isRecursiveSearchActive_(false)
+    , hasPendingRecursiveSearch_(false)
+    , rangeSelectionStart_(0)
+    , editDir_(false)
+    , setFocusToEditDir_(false)
+    , metadataGeneration_(0)
+    , backgroundMetadataRequestCount_(0)
+    , sortColumn_(SortColumn_Name)
+    , sortDescending_(false)
+    , areDirectorySizesSorted_(false)
+    , previewMaxEntries_(32)
+    , previewMaxBytesPerFile_(1024)
+{
+    assert(!((flags_ & ImGuiFileBrowserFlags_SelectDirectory) && (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)) &&
+           "'EnterNewFilename' doesn't work when 'SelectDirectory' is enabled");
+    if(flags_ & ImGuiFileBrowserFlags_CreateNewDir)
+    {
+        newDirNameBuffer_.resize(32, '\0');
+    }
+
+    SetTitle("file browser");
+    SetDirectory(defaultDirectory_);
+
+    typeFilters_.clear();
+    typeFilterMatchers_.clear();
+    typeFilterMatches_.clear();
+    typeFilterIndex_ = 0;
+    visibleRecordIndicesDirty_ = true;
+
+#ifdef _WIN32
+    drives_ = GetDrivesBitMask();
+#endif
+}
+
+inline ImGui::FileBrowser::FileBrowser(const FileBrowser &copyFrom)
+    : FileBrowser()
+{
+    *this = copyFrom;
+}
+
+inline ImGui::FileBrowser &ImGui::FileBrowser::operator=(
+    const FileBrowser &copyFrom)
+{
+    width_  = copyFrom.width_;
+    height_ = copyFrom.height_;
+
+    posX_ = copyFrom.posX_;
+    posY_ = copyFrom.posY_;
+
+    flags_ = copyFrom.flags_;
+    SetTitle(copyFrom.title_);
+
+    shouldOpen_  = copyFrom.shouldOpen_;
+    shouldClose_ = copyFrom.shouldClose_;
+    isOpened_    = copyFrom.isOpened_;
+    isOk_        = copyFrom.isOk_;
+    isPosSet_    = copyFrom.isPosSet_;
+
+    statusStr_ = "";
+
+    typeFilters_        = copyFrom.typeFilters_;
+    typeFilterMatchers_ = copyFrom.typeFilterMatchers_;
+    typeFilterMatches_  = copyFrom.typeFilterMatches_;
+    typeFilterIndex_    = copyFrom.typeFilterIndex_;
+
+    selectedRecords_     = copyFrom.selectedRecords_;
+    selectableRecords_   = copyFrom.selectableRecords_;
+    selectedInputName_   = copyFrom.selectedInputName_;
+    rangeSelectionStart_ = copyFrom.rangeSelectionStart_;
+
+    currentDirectory_ = copyFrom.currentDirectory_;
+    fileRecords_      = copyFrom.fileRecords_;
+
+    parallelSortThreshold_ = copyFrom.parallelSortThreshold_;
+
+    // cached listings are not copied. they will be rebuilt on demand
+    fileRecordsWriteTime_   = copyFrom.fileRecordsWriteTime_;
+    listingCacheMaxEntries_ = copyFrom.listingCacheMaxEntries_;
+    listingCacheMaxBytes_   = copyFrom.listingCacheMaxBytes_;
+    listingCache_.clear();
+
+    backHistory_    = copyFrom.backHistory_;
+    forwardHistory_ = copyFrom.forwardHistory_;
+
+    navigationDebounceTime_ = copyFrom.navigationDebounceTime_;
+
+    // previews are loaded again on demand
+    previewLoader_.reset();
+    previewRequest_.clear();
+    preview_ = FilePreview();
+    previewMaxEntries_      = copyFrom.previewMaxEntries_;
+    previewMaxBytesPerFile_ = copyFrom.previewMaxBytesPerFile_;
+
+    // a search still in flight is restarted by our own worker
+    recursiveSearchOptions_    = copyFrom.recursiveSearchOptions_;
+    recursiveSearch_           = copyFrom.recursiveSearch_;
+    isRecursiveSearchActive_   = copyFrom.isRecursiveSearchActive_ && !copyFrom.asyncEnumeration_;
+    hasPendingRecursiveSearch_ =
+        copyFrom.hasPendingRecursiveSearch_ || (copyFrom.isRecursiveSearchActive_ && copyFrom.asyncEnumeration_);
+    lastSearchEditTime_        = copyFrom.lastSearchEditTime_;
+
+    // prefetched listings of copyFrom are not ours to pick up
+    directoryPrefetcher_.reset();
+    lastPrefetchRequest_.clear();
+
+    visibleRecordIndicesDirty_ = true;
+
+    // the worker and the opened iterator of copyFrom can't be shared. start our own enumeration instead
+    CancelEnumeration();
+    if(copyFrom.asyncEnumeration_ || copyFrom.hasPendingEnumeration_)
+    {
+        UpdateFileRecords();
+    }
+
+    openNewDirLabel_     = copyFrom.openNewDirLabel_;
+    newDirNameBuffer_    = copyFrom.newDirNameBuffer_;
+    inputNameBuffer_     = copyFrom.inputNameBuffer_;
+    customizedInputName_ = copyFrom.customizedInputName_;
+
+    editDir_ = copyFrom.editDir_;
+    currDirBuffer_ = copyFrom.currDirBuffer_;
+
+    searchBuffer_  = copyFrom.searchBuffer_;
+    searchQuery_   = copyFrom.searchQuery_;
+    searchMatches_ = copyFrom.searchMatches_;
+
+    sortColumn_     = copyFrom.sortColumn_;
+    sortDescending_ = copyFrom.sortDescending_;
+    extensionRanks_ = copyFrom.extensionRanks_;
+
+    // metadata requested by copyFrom will never arrive here
+    ResetRecordMetadata();
+    recordMetadata_ = copyFrom.recordMetadata_;
+    for(auto &metadata : recordMetadata_)
+    {
+        if(metadata.state == RecordMetadata::State_Pending)
+        {
+            metadata.state = RecordMetadata::State_Unknown;
+        }
+    }
+
+#ifdef _WIN32
+    drives_ = copyFrom.drives_;
+#endif
+
+    return *this;
+}
+
+inline ImGui::FileBrowser::~FileBrowser() = default;
+
+inline void ImGui::FileBrowser::SetWindowPos(int posX, int posY) noexcept
+{
+    posX_ = posX;
+    posY_ = posY;
+    isPosSet_ = true;
+}
+
+inline void ImGui::FileBrowser::SetWindowSize(int width, int height) noexcept
+{
+    assert(width > 0 && height > 0);
+    width_  = width;
+    height_ = height;
+}
+
+inline void ImGui::FileBrowser::SetTitle(std::string title)
+{
+    title_ = std::move(title);
+
+    const std::string thisPtrStr = std::to_string(reinterpret_cast<size_t>(this));
+    openLabel_ = title_ + "##filebrowser_" + thisPtrStr;
+    openNewDirLabel_ = "new dir##new_dir_" + thisPtrStr;
+}
+
+inline void ImGui::FileBrowser::Open()
+{
+    UpdateFileRecords();
+    ClearSelected();
+    statusStr_ = std::string();
+    shouldOpen_ = true;
+    shouldClose_ = false;
+    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) && !customizedInputName_.empty())
+    {
+        AssignToArrayStyleString(inputNameBuffer_, customizedInputName_);
+        selectedInputName_ = u8StrToPath(inputNameBuffer_.data());
+    }
+}
+
+inline void ImGui::FileBrowser::Close()
+{
+    ClearSelected();
+    statusStr_ = std::string();
+    shouldClose_ = true;
+    shouldOpen_ = false;
+}
+
+inline bool ImGui::FileBrowser::IsOpened() const noexcept
+{
+    return isOpened_;
+}
+
+inline void ImGui::FileBrowser::Display()
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::Display");
+    const auto frameStartTime = std::chrono::steady_clock::now();
+
+    PushID(this);
+    ScopeGuard exitThis([this]
+    {
+        shouldOpen_ = false;
+        shouldClose_ = false;
+        PopID();
+    });
+
+    PollPendingEnumeration();
+    PollAsyncEnumeration();
+    PollRecordMetadata();
+    PollPrefetchedListings();
+
+    if(shouldOpen_)
+    {
+        OpenPopup(openLabel_.c_str());
+    }
+    isOpened_ = false;
+
+    // open the popup window
+
+    if(shouldOpen_ && (flags_ & ImGuiFileBrowserFlags_NoModal))
+    {
+        if(isPosSet_)
+        {
+            SetNextWindowPos(ImVec2(static_cast<float>(posX_), static_cast<float>(posY_)));
+        }
+        SetNextWindowSize(ImVec2(static_cast<float>(width_), static_cast<float>(height_)));
+    }
+    else
+    {
+        if(isPosSet_)
+        {
+            SetNextWindowPos(ImVec2(static_cast<float>(posX_), static_cast<float>(posY_)), ImGuiCond_FirstUseEver);
+        }
+        SetNextWindowSize(ImVec2(static_cast<float>(width_), static_cast<float>(height_)), ImGuiCond_FirstUseEver);
+    }
+    const bool isPopupOpened =
+        (flags_ & ImGuiFileBrowserFlags_NoModal) ?
+        BeginPopup(openLabel_.c_str()) :
+        BeginPopupModal(openLabel_.c_str(), nullptr,
+                        flags_ & ImGuiFileBrowserFlags_NoTitleBar ? ImGuiWindowFlags_NoTitleBar : 0);
+    if(!isPopupOpened)
+    {
+        // nothing will be entered while closed
+        directoryPrefetcher_.reset();
+        lastPrefetchRequest_.clear();
+        CancelDirectorySizes();
+        return;
+    }
+
+    isOpened_ = true;
+    ScopeGuard recordFrameTime([&] { RecordFrameTime(GetMillisecondsSince(frameStartTime)); });
+    ScopeGuard endPopup([] { EndPopup(); });
+
+    if(flags_ & ImGuiFileBrowserFlags_WatchDirectory)
+    {
+        UpdateDirectoryWatcher();
+    }
+
+    std::filesystem::path newDir; bool shouldSetNewDir = false;
+
+    if(editDir_)
+    {
+        if(setFocusToEditDir_) // Automatically set the text box to be focused on appearing
+        {
+            SetKeyboardFocusHere();
+        }
+
+        PushItemWidth(-1);
+        const bool enter = InputText(
+            "##directory", currDirBuffer_.data(), currDirBuffer_.size(),
+            ImGuiInputTextFlags_CallbackResize | ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll,
+            ExpandInputBuffer, &currDirBuffer_);
+        PopItemWidth();
+
+        if(!IsItemActive() && !setFocusToEditDir_)
+        {
+            editDir_ = false;
+        }
+        setFocusToEditDir_ = false;
+
+        if(enter)
+        {
+            std::filesystem::path enteredDir = u8StrToPath(currDirBuffer_.data());
+            if(is_directory(enteredDir))
+            {
+                newDir = std::move(enteredDir);
+                shouldSetNewDir = true;
+            }
+            else if(is_directory(enteredDir.parent_path()))
+            {
+                newDir = enteredDir.parent_path();
+                shouldSetNewDir = true;
+            }
+            else
+            {
+                statusStr_ = "[" + std::string(currDirBuffer_.data()) + "] is not a valid directory";
+            }
+        }
+    }
+    else
+    {
+        if(SmallButton("<"))
+        {
+            NavigateHistory(backHistory_, forwardHistory_);
+        }
+        else
+        {
+            ToolTip("Back (Alt+Left)");
+        }
+        SameLine();
+        if(SmallButton(">"))
+        {
+            NavigateHistory(forwardHistory_, backHistory_);
+        }
+        else
+        {
+            ToolTip("Forward (Alt+Right)");
+        }
+        SameLine();
+
+        // display elements in pwd
+
+#ifdef _WIN32
+        const char currentDrive = static_cast<char>(currentDirectory_.c_str()[0]);
+        const char driveStr[] = { currentDrive, ':', '\0' };
+
+        PushItemWidth(4 * GetFontSize());
+        if(BeginCombo("##select_drive", driveStr))
+        {
+            ScopeGuard guard([&] { EndCombo(); });
+
+            for(int i = 0; i < 26; ++i)
+            {
+                if(!(drives_ & (1 << i)))
+                {
+                    continue;
+                }
+
+                const char driveCh = static_cast<char>('A' + i);
+                const char selectableStr[] = { driveCh, ':', '\0' };
+                const bool selected = currentDrive == driveCh;
+
+                if(Selectable(selectableStr, selected) && !selected)
+                {
+                    char newPwd[] = { driveCh, ':', '\\', '\0' };
+                    SetDirectory(newPwd);
+                }
+            }
+        }
+        PopItemWidth();
+
+        SameLine();
+#endif
+
+        int secIdx = 0, newDirLastSecIdx = -1, hoveredSecIdx = -1;
+        for(const auto &sec : currentDirectory_)
+        {
+#ifdef _WIN32
+            if(secIdx == 1)
+            {
+                ++secIdx;
+                continue;
+            }
+#endif
+
+            PushID(secIdx);
+            if(secIdx > 0)
+            {
+                SameLine();
+            }
+            if(SmallButton(u8StrToStr(sec.u8string()).c_str()))
+            {
+                newDirLastSecIdx = secIdx;
+            }
+            else if(IsItemHovered())
+            {
+                hoveredSecIdx = secIdx;
+            }
+            PopID();
+
+            ++secIdx;
+        }
+
+        auto getSectionPath = [&](int lastSecIdx)
+        {
+            int i = 0;
+            std::filesystem::path dstDir;
+            for(const auto &sec : currentDirectory_)
+            {
+                if(i++ > lastSecIdx)
+                {
+                    break;
+                }
+                dstDir /= sec;
+            }
+
+#ifdef _WIN32
+            if(lastSecIdx == 0)
+            {
+                dstDir /= "\\";
+            }
+#endif
+            return dstDir;
+        };
+
+        if(newDirLastSecIdx >= 0)
+        {
+            SetDirectory(getSectionPath(newDirLastSecIdx));
+        }
+        else if(hoveredSecIdx >= 0 && (flags_ & ImGuiFileBrowserFlags_PrefetchDirectories))
+        {
+            RequestPrefetch(getSectionPath(hoveredSecIdx));
+        }
+
+        if(flags_ & ImGuiFileBrowserFlags_EditPathString)
+        {
+            SameLine();
+
+            if(SmallButton("#"))
+            {
+                const auto currDirStr = u8StrToStr(currentDirectory_.u8string());
+                currDirBuffer_.resize(currDirStr.size() + 1);
+                std::memcpy(currDirBuffer_.data(), currDirStr.data(), currDirStr.size());
+                currDirBuffer_.back() = '\0';
+
+                editDir_ = true;
+                setFocusToEditDir_ = true;
+            }
+            else
+            {
+                ToolTip("Edit the current path");
+            }
+        }
+    }
+
+    SameLine();
+    if(SmallButton("*"))
+    {
+#ifdef _WIN32
+        drives_ = GetDrivesBitMask();
+#endif
+
+        RecalculateDirectorySizes();
+        RefreshFileRecords();
+    }
+    else
+    {
+        ToolTip("Refresh");
+    }
+
+    bool focusOnInputText = false;
+    if(flags_ & ImGuiFileBrowserFlags_CreateNewDir)
+    {
+        SameLine();
+        if(SmallButton("+"))
+        {
+            OpenPopup(openNewDirLabel_.c_str());
+            newDirNameBuffer_[0] = '\0';
+        }
+        else
+        {
+            ToolTip("Create a new directory");
+        }
+
+        if(BeginPopup(openNewDirLabel_.c_str()))
+        {
+            ScopeGuard endNewDirPopup([] { EndPopup(); });
+
+            InputText(
+                "name", newDirNameBuffer_.data(), newDirNameBuffer_.size(),
+                ImGuiInputTextFlags_CallbackResize, ExpandInputBuffer, &newDirNameBuffer_);
+            focusOnInputText |= IsItemFocused();
+            SameLine();
+
+            if(Button("ok") && newDirNameBuffer_[0] != '\0')
+            {
+                ScopeGuard closeNewDirPopup([] { CloseCurrentPopup(); });
+                if(create_directory(currentDirectory_ / u8StrToPath(newDirNameBuffer_.data())))
+                {
+                    RefreshFileRecords();
+                }
+                else
+                {
+                    statusStr_ = "failed to create " + std::string(newDirNameBuffer_.data());
+                }
+            }
+        }
+    }
+
+    if(flags_ & ImGuiFileBrowserFlags_SearchBox)
+    {
+        if(searchBuffer_.empty())
+        {
+            searchBuffer_.resize(32, '\0');
+        }
+
+        const bool showRecursiveSearch = flags_ & ImGuiFileBrowserFlags_RecursiveSearch;
+        PushItemWidth(showRecursiveSearch ? -7 * GetFontSize() : -1);
+        if(InputTextWithHint(
+            "##search", "search", searchBuffer_.data(), searchBuffer_.size(),
+            ImGuiInputTextFlags_CallbackResize, ExpandInputBuffer, &searchBuffer_))
+        {
+            SetSearchQuery(searchBuffer_.data());
+            UpdateRecursiveSearch();
+        }
+        focusOnInputText |= IsItemFocused();
+        PopItemWidth();
+
+        if(showRecursiveSearch)
+        {
+            SameLine();
+            if(Checkbox("subfolders", &recursiveSearch_))
+            {
+                UpdateRecursiveSearch();
+            }
+        }
+    }
+
+    // browse files in a child window
+
+    float reserveHeight = GetFrameHeightWithSpacing();
+    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+    {
+        reserveHeight += GetFrameHeightWithSpacing();
+    }
+
+    // the row with keyboard focus, which follows clicks and arrow keys, or the first selected file
+    const bool showPreview = flags_ & ImGuiFileBrowserFlags_ShowPreview;
+    size_t previewRecordIndex = RecordBitset::npos;
+
+    {
+        const float previewWidth = showPreview ? 0.35f * GetContentRegionAvail().x : 0.0f;
+        BeginChild("ch", ImVec2(-previewWidth, -reserveHeight), true,
+                   (flags_ & ImGuiFileBrowserFlags_NoModal) ? ImGuiWindowFlags_AlwaysHorizontalScrollbar : 0);
+        ScopeGuard endChild([] { EndChild(); });
+        IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::DrawRecords");
+
+        const bool showDetails =
+            (flags_ & ImGuiFileBrowserFlags_ShowDetails) &&
+            BeginTable("##records", 5,
+                       ImGuiTableFlags_Resizable | ImGuiTableFlags_Hideable | ImGuiTableFlags_Reorderable |
+                       ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersInnerV |
+                       ImGuiTableFlags_Sortable);
+        ScopeGuard endTable([&] { if(showDetails) { EndTable(); } });
+        std::vector<uint32_t> metadataRequests;
+        if(showDetails)
+        {
+            TableSetupScrollFreeze(0, 1);
+            TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_NoHide |
+                             ImGuiTableColumnFlags_DefaultSort, 0.0f, SortColumn_Name);
+            TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 6 * GetFontSize(), SortColumn_Size);
+            TableSetupColumn("Modified", ImGuiTableColumnFlags_WidthFixed, 8 * GetFontSize(), SortColumn_Modified);
+            TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 5 * GetFontSize(), SortColumn_Extension);
+            TableSetupColumn("Permissions", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_DefaultHide |
+                             ImGuiTableColumnFlags_NoSort, 6 * GetFontSize());
+            TableHeadersRow();
+
+            // only the order of visible indices changes. records are never re-enumerated for sorting
+            if(ImGuiTableSortSpecs *sortSpecs = TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsDirty)
+            {
+                if(sortSpecs->SpecsCount > 0)
+                {
+                    const ImGuiTableColumnSortSpecs &spec = sortSpecs->Specs[0];
+                    sortColumn_ = static_cast<SortColumn>(spec.ColumnUserID);
+                    sortDescending_ = spec.SortDirection == ImGuiSortDirection_Descending;
+                }
+                else
+                {
+                    sortColumn_ = SortColumn_Name;
+                    sortDescending_ = false;
+                }
+                sortSpecs->SpecsDirty = false;
+                visibleRecordIndicesDirty_ = true;
+            }
+
+            // records streamed in by the background enumeration have no metadata yet
+            if(recordMetadata_.size() < fileRecords_.Size())
+            {
+                recordMetadata_.resize(fileRecords_.Size());
+            }
+
+            // sorting by metadata needs it for every record, not only the visible rows
+            if(sortColumn_ == SortColumn_Size || sortColumn_ == SortColumn_Modified)
+            {
+                RequestAllRecordMetadata();
+            }
+
+            if(flags_ & ImGuiFileBrowserFlags_DirectorySizes)
+            {
+                UpdateDirectorySizes();
+            }
+        }
+
+        UpdateVisibleRecordIndices();
+
+        // only submit the rows inside the visible region of the child window
+        std::string rowLabel;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(visibleRecordIndices_.size()));
+        drawnRowCount_ = 0;
+        while(clipper.Step())
+        {
+            drawnRowCount_ += static_cast<size_t>(clipper.DisplayEnd - clipper.DisplayStart);
+            for(int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+            {
+                const unsigned int rscIndex = visibleRecordIndices_[row];
+                const bool rscIsDir = fileRecords_.IsDir(rscIndex);
+                const std::string_view rscName = fileRecords_.GetName(rscIndex);
+
+                const bool selected = selectedRecords_.Test(rscIndex);
+
+                rowLabel.assign(rscIsDir ? "[D] " : "[F] ");
+                rowLabel.append(rscName);
+
+#if IMGUI_VERSION_NUM >= 19100
+                ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_NoAutoClosePopups;
+#else
+                ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_DontClosePopups;
+#endif
+
+                if(showDetails)
+                {
+                    TableNextRow();
+                    TableSetColumnIndex(0);
+                    selectableFlag |= ImGuiSelectableFlags_SpanAllColumns;
+                    if(rscIndex > 0 && recordMetadata_[rscIndex].state == RecordMetadata::State_Unknown)
+                    {
+                        metadataRequests.push_back(rscIndex);
+                    }
+                }
+
+                if(Selectable(rowLabel.c_str(), selected, selectableFlag))
+                {
+                    const bool wantDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
+                    const bool canSelect = rscName != ".." && rscIsDir == wantDir;
+                    const bool rangeSelect =
+                        canSelect && GetIO().KeyShift &&
+                        rangeSelectionStart_ < fileRecords_.Size() &&
+                        (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
+                        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+                    const bool multiSelect =
+                        !rangeSelect && GetIO().KeyCtrl &&
+                        (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
+                        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+
+                    if(rangeSelect && IsViewSortedByName())
+                    {
+                        const unsigned int first = (std::min)(rangeSelectionStart_, rscIndex);
+                        const unsigned int last = (std::max)(rangeSelectionStart_, rscIndex);
+                        selectedRecords_.Reset();
+                        selectedRecords_.SetRange(first, last + 1);
+                        selectedRecords_.And(selectableRecords_);
+                        selectedInputName_.clear();
+                    }
+                    else if(rangeSelect)
+                    {
+                        // the range spans rows of the view, which are not contiguous records anymore
+                        const auto anchor = std::find(
+                            visibleRecordIndices_.begin(), visibleRecordIndices_.end(), rangeSelectionStart_);
+                        const int anchorRow = anchor != visibleRecordIndices_.end() ?
+                                              static_cast<int>(anchor - visibleRecordIndices_.begin()) : row;
+                        selectedRecords_.Reset();
+                        for(int i = (std::min)(anchorRow, row); i <= (std::max)(anchorRow, row); ++i)
+                        {
+                            selectedRecords_.Set(visibleRecordIndices_[i]);
+                        }
+                        selectedRecords_.And(selectableRecords_);
+                        selectedInputName_.clear();
+                    }
+                    else if(selected)
+                    {
+                        if(!multiSelect)
+                        {
+                            SelectSingleRecord(rscIndex);
+                            rangeSelectionStart_ = rscIndex;
+                        }
+                        else
+                        {
+                            selectedRecords_.Set(rscIndex, false);
+                        }
+                        if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+                        {
+                            AssignToArrayStyleString(inputNameBuffer_, "");
+                        }
+                    }
+                    else if(canSelect)
+                    {
+                        if(multiSelect)
+                        {
+                            selectedRecords_.Set(rscIndex);
+                        }
+                        else
+                        {
+                            SelectSingleRecord(rscIndex);
+                        }
+                        if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+                        {
+                            AssignToArrayStyleString(inputNameBuffer_, rscName);
+                        }
+                        rangeSelectionStart_ = rscIndex;
+                    }
+                }
+
+                if(IsMouseDoubleClicked(ImGuiMouseButton_Left) && IsItemHovered(ImGuiHoveredFlags_None))
+                {
+                    if(rscIsDir)
+                    {
+                        shouldSetNewDir = true;
+                        newDir = (rscName != "..") ?
+                                 (currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(rscIndex))) :
+                                 currentDirectory_.parent_path();
+                    }
+                    else if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+                    {
+                        SelectSingleRecord(rscIndex);
+                        isOk_ = true;
+                        CloseCurrentPopup();
+                    }
+                }
+                else if(IsKeyPressed(ImGuiKey_GamepadFaceDown) && IsItemHovered()) 
+                {
+                    if(rscIsDir)
+                    {
+                        shouldSetNewDir = true;
+                        newDir = (rscName != "..") ?
+                                 (currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(rscIndex))) :
+                                 currentDirectory_.parent_path();
+                        SetKeyboardFocusHere(-1);
+                    }
+                    else if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+                    {
+                        SelectSingleRecord(rscIndex);
+                        isOk_ = true;
+                        CloseCurrentPopup();
+                    }
+                }
+                else if(rscIsDir && (flags_ & ImGuiFileBrowserFlags_PrefetchDirectories) && IsItemHovered())
+                {
+                    RequestPrefetch((rscName != "..") ?
+                                    (currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(rscIndex))) :
+                                    currentDirectory_.parent_path());
+                }
+
+                if(showPreview && !rscIsDir && IsItemFocused())
+                {
+                    previewRecordIndex = rscIndex;
+                }
+
+                if(showDetails)
+                {
+                    DrawRecordDetails(rscIndex);
+                }
+            }
+        }
+
+        if(showDetails)
+        {
+            RequestRecordMetadata(metadataRequests);
+        }
+    }
+
+    if(showPreview)
+    {
+        if(previewRecordIndex == RecordBitset::npos)
+        {
+            for(size_t i = selectedRecords_.FindNext(0); i != RecordBitset::npos; i = selectedRecords_.FindNext(i + 1))
+            {
+                if(!fileRecords_.IsDir(i))
+                {
+                    previewRecordIndex = i;
+                    break;
+                }
+            }
+        }
+
+        SameLine();
+        DrawPreview(previewRecordIndex, reserveHeight);
+    }
+
+    if(shouldSetNewDir)
+    {
+        SetDirectory(newDir);
+    }
+
+    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+    {
+        PushID(this);
+        ScopeGuard popTextID([] { PopID(); });
+
+        if(inputNameBuffer_.empty())
+        {
+            inputNameBuffer_.resize(1, '\0');
+        }
+
+        PushItemWidth(-1);
+        if(InputText(
+            "", inputNameBuffer_.data(), inputNameBuffer_.size(),
+            ImGuiInputTextFlags_CallbackResize, ExpandInputBuffer, &inputNameBuffer_) && inputNameBuffer_[0] != '\0')
+        {
+            selectedRecords_.Reset();
+            selectedInputName_ = u8StrToPath(inputNameBuffer_.data());
+        }
+        focusOnInputText |= IsItemFocused();
+        PopItemWidth();
+    }
+
+    if(!focusOnInputText && !editDir_)
+    {
+        const bool selectAll = (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
+                               IsKeyPressed(ImGuiKey_A) && (IsKeyDown(ImGuiKey_LeftCtrl) ||
+                               IsKeyDown(ImGuiKey_RightCtrl));
+        if(selectAll)
+        {
+            UpdateVisibleRecordIndices();
+            selectedRecords_ = selectableRecords_;
+            selectedInputName_.clear();
+        }
+
+        if(GetIO().KeyAlt && IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows))
+        {
+            if(IsKeyPressed(ImGuiKey_LeftArrow))
+            {
+                NavigateHistory(backHistory_, forwardHistory_);
+            }
+            else if(IsKeyPressed(ImGuiKey_RightArrow))
+            {
+                NavigateHistory(forwardHistory_, backHistory_);
+            }
+        }
+    }
+
+    const bool isEnterPressed =
+        (flags_ & ImGuiFileBrowserFlags_ConfirmOnEnter) &&
+        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+        IsKeyPressed(ImGuiKey_Enter);
+    if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+    {
+        if((Button(" ok ") || isEnterPressed) && HasAnySelection())
+        {
+            isOk_ = true;
+            CloseCurrentPopup();
+        }
+    }
+    else
+    {
+        if(Button(" ok ") || isEnterPressed)
+        {
+            isOk_ = true;
+            CloseCurrentPopup();
+        }
+    }
+
+    SameLine();
+
+    const bool shouldClose =
+        Button("cancel") || shouldClose_ ||
+        ((flags_ & ImGuiFileBrowserFlags_CloseOnEsc) &&
+        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+        IsKeyPressed(ImGuiKey_Escape));
+    if(shouldClose)
+    {
+        CloseCurrentPopup();
+    }
+
+    if(!statusStr_.empty() && !(flags_ & ImGuiFileBrowserFlags_NoStatusBar))
+    {
+        SameLine();
+        Text("%s", statusStr_.c_str());
+    }
+
+    if(asyncEnumeration_ && !(flags_ & ImGuiFileBrowserFlags_NoStatusBar))
+    {
+        SameLine();
+        if(isRecursiveSearchActive_)
+        {
+            Text("searching... %zu found", fileRecords_.Size() - 1);
+        }
+        else
+        {
+            Text("loading %zu entries...", fileRecords_.Size() - 1);
+        }
+    }
+
+    if((flags_ & ImGuiFileBrowserFlags_ShowStats) && !(flags_ & ImGuiFileBrowserFlags_NoStatusBar))
+    {
+        const Stats stats = GetStats();
+        SameLine();
+        TextDisabled(
+            "%zu entries | enum %.1f ms | sort %.1f ms | frame %.2f/%.2f ms",
+            stats.recordCount, stats.enumerationMs, stats.sortMs, stats.frameMsP50, stats.frameMsP99);
+        if(IsItemHovered())
+        {
+            SetTooltip(
+                "scanned: %zu (%zu skipped)\n"
+                "filter: %.2f ms\n"
+                "visible: %zu, drawn: %zu\n"
+                "selected: %zu\n"
+                "memory: %zu KiB\n"
+                "frame: %.2f ms (p50 %.2f, p99 %.2f)",
+                stats.scannedEntryCount, stats.skippedEntryCount, stats.filterMs,
+                stats.visibleRecordCount, stats.drawnRowCount, stats.selectedCount, stats.memoryUsage / 1024,
+                stats.frameMs, stats.frameMsP50, stats.frameMsP99);
+        }
+    }
+
+    if(!typeFilters_.empty())
+    {
+        SameLine();
+        PushItemWidth(8 * GetFontSize());
+        if(BeginCombo(
+            "##type_filters", typeFilters_[typeFilterIndex_].c_str()))
+        {
+            ScopeGuard guard([&] { EndCombo(); });
+
+            for(size_t i = 0; i < typeFilters_.size(); ++i)
+            {
+                bool selected = i == typeFilterIndex_;
+                if(Selectable(typeFilters_[i].c_str(), selected) && !selected)
+                {
+                    SetCurrentTypeFilterIndex(static_cast<int>(i));
+                }
+            }
+        }
+        PopItemWidth();
+    }
+}
+
+inline bool ImGui::FileBrowser::HasSelected() const noexcept
+{
+    return isOk_;
+}
+
+inline bool ImGui::FileBrowser::IsLoading() const noexcept
+{
+    return asyncEnumeration_ != nullptr || hasPendingEnumeration_;
+}
+
+inline bool ImGui::FileBrowser::SetDirectory(const std::filesystem::path &dir)
+{
+    const std::filesystem::path preferredFallback = this->GetDirectory();
+    const bool ret = SetCurrentDirectoryInternal(dir, preferredFallback);
+
+    if(!preferredFallback.empty() && currentDirectory_ != preferredFallback)
+    {
+        constexpr size_t MAX_HISTORY_SIZE = 64;
+        if(backHistory_.size() >= MAX_HISTORY_SIZE)
+        {
+            backHistory_.erase(backHistory_.begin());
+        }
+        backHistory_.push_back(preferredFallback);
+        forwardHistory_.clear();
+    }
+
+    return ret;
+}
+
+inline const std::filesystem::path &ImGui::FileBrowser::GetDirectory() const noexcept
+{
+    return currentDirectory_;
+}
+
+inline std::filesystem::path ImGui::FileBrowser::GetSelected() const
+{
+    if(!selectedInputName_.empty())
+    {
+        return currentDirectory_ / selectedInputName_;
+    }
+
+    // when isOk_ is true, the selection may be empty if SelectDirectory
+    // is enabled. return pwd in that case.
+    const size_t index = selectedRecords_.FindNext(0);
+    if(index == RecordBitset::npos)
+    {
+        return currentDirectory_;
+    }
+    return currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(index));
+}
+
+inline std::vector<std::filesystem::path> ImGui::FileBrowser::GetMultiSelected() const
+{
+    if(!HasAnySelection())
+    {
+        return { currentDirectory_ };
+    }
+
+    std::vector<std::filesystem::path> ret;
+    ret.reserve(selectedRecords_.Count() + 1);
+    for(size_t i = selectedRecords_.FindNext(0); i != RecordBitset::npos; i = selectedRecords_.FindNext(i + 1))
+    {
+        ret.push_back(currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(i)));
+    }
+    if(!selectedInputName_.empty())
+    {
+        ret.push_back(currentDirectory_ / selectedInputName_);
+    }
+
+    return ret;
+}
+
+inline void ImGui::FileBrowser::ClearSelected()
+{
+    selectedRecords_.Reset();
+    selectedInputName_.clear();
+    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename))
+    {
+        AssignToArrayStyleString(inputNameBuffer_, "");
+    }
+    isOk_ = false;
+}
+
+inline void ImGui::FileBrowser::SetTypeFilters(const std::vector<std::string> &_typeFilters)
+{
+    typeFilters_.clear();
+
+    // remove duplicate filter names due to case unsensitivity on windows
+
+#ifdef _WIN32
+
+    std::vector<std::string> typeFilters;
+    for(auto &rawFilter : _typeFilters)
+    {
+        std::string lowerFilter = ToLower(rawFilter);
+        const auto it = std::find(typeFilters.begin(), typeFilters.end(), lowerFilter);
+        if(it == typeFilters.end())
+        {
+            typeFilters.push_back(std::move(lowerFilter));
+        }
+    }
+
+#else
+
+    auto &typeFilters = _typeFilters;
+
+#endif
+
+#ifdef _WIN32
+    const bool ignoreCase = true;
+#else
+    const bool ignoreCase = flags_ & ImGuiFileBrowserFlags_IgnoreTypeFilterCase;
+#endif
+
+    typeFilterMatchers_.clear();
+
+    // insert auto-generated filter
+    bool hasAllFilter = false;
+    if(typeFilters.size() > 1)
+    {
+        hasAllFilter = true;
+        std::string allFiltersName = std::string();
+        TypeFilterMatcher allFiltersMatcher(ignoreCase);
+        for(size_t i = 0; i < typeFilters.size(); ++i)
+        {
+            if(typeFilters[i] == std::string_view(".*"))
+            {
+                hasAllFilter = false;
+                break;
+            }
+
+            if(i > 0)
+            {
+                allFiltersName += ",";
+            }
+            allFiltersName += typeFilters[i];
+            allFiltersMatcher.Add(typeFilters[i]);
+        }
+
+        if(hasAllFilter)
+        {
+            typeFilters_.push_back(std::move(allFiltersName));
+            typeFilterMatchers_.push_back(std::move(allFiltersMatcher));
+        }
+    }
+
+    std::copy(typeFilters.begin(), typeFilters.end(), std::back_inserter(typeFilters_));
+    for(auto &filter : typeFilters)
+    {
+        typeFilterMatchers_.emplace_back(ignoreCase);
+        typeFilterMatchers_.back().Add(filter);
+    }
+
+    typeFilterMatches_.assign(typeFilters_.size(), RecordBitset());
+    typeFilterIndex_ = 0;
+    visibleRecordIndicesDirty_ = true;
+}
+
+inline void ImGui::FileBrowser::SetCurrentTypeFilterIndex(int index)
+{
+    typeFilterIndex_ = static_cast<unsigned int>(index);
+    visibleRecordIndicesDirty_ = true;
+
+    // files not matching the previous filter were never collected
+    if(isRecursiveSearchActive_ || hasPendingRecursiveSearch_)
+    {
+        UpdateRecursiveSearch();
+    }
+}
+
+inline void ImGui::FileBrowser::SetInputName(std::string_view input)
+{
+    assert((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) &&
+           "SetInputName can only be called when ImGuiFileBrowserFlags_EnterNewFilename is enabled");
+    customizedInputName_ = input;
+}
+
+inline size_t ImGui::FileBrowser::GetMemoryUsage() const noexcept
+{
+    return fileRecords_.GetMemoryUsage() + recordMetadata_.capacity() * sizeof(RecordMetadata);
+}
+
+inline ImGui::FileBrowser::Stats ImGui::FileBrowser::GetStats() const
+{
+    Stats ret;
+    ret.scannedEntryCount  = lastEnumerationStats_.scannedCount;
+    ret.skippedEntryCount  = lastEnumerationStats_.skippedCount;
+    ret.enumerationMs      = lastEnumerationStats_.enumerationMs;
+    ret.sortMs             = lastEnumerationStats_.sortMs;
+    ret.filterMs           = lastFilterMs_;
+    ret.recordCount        = fileRecords_.Size() ? fileRecords_.Size() - 1 : 0;
+    ret.visibleRecordCount = visibleRecordIndices_.empty() ? 0 : visibleRecordIndices_.size() - 1;
+    ret.drawnRowCount      = drawnRowCount_;
+    ret.selectedCount      = selectedRecords_.Count() + (selectedInputName_.empty() ? 0 : 1);
+    ret.memoryUsage        = GetMemoryUsage();
+    if(frameTimeSampleCount_)
+    {
+        ret.frameMs = frameTimeSamples_[(frameTimeSampleCount_ - 1) % FRAME_TIME_SAMPLE_COUNT];
+    }
+    ret.frameMsP50 = GetFrameTimePercentile(0.5);
+    ret.frameMsP99 = GetFrameTimePercentile(0.99);
+    return ret;
+}
+
+inline void ImGui::FileBrowser::SetParallelSortThreshold(size_t threshold) noexcept
+{
+    parallelSortThreshold_ = threshold;
+}
+
+inline const ImGui::FileBrowser::RefreshStats &ImGui::FileBrowser::GetLastRefreshStats() const noexcept
+{
+    return lastRefreshStats_;
+}
+
+inline void ImGui::FileBrowser::SetListingCacheCapacity(size_t maxEntries, size_t maxBytes)
+{
+    listingCacheMaxEntries_ = maxEntries;
+    listingCacheMaxBytes_ = maxBytes;
+    TrimListingCache();
+}
+
+inline void ImGui::FileBrowser::SetNavigationDebounceTime(std::chrono::milliseconds time) noexcept
+{
+    navigationDebounceTime_ = time;
+}
+
+inline void ImGui::FileBrowser::SetRecursiveSearchOptions(RecursiveSearchOptions options)
+{
+    recursiveSearchOptions_ = std::move(options);
+}
+
+inline void ImGui::FileBrowser::SetPreviewCacheCapacity(size_t maxEntries, size_t maxBytesPerFile)
+{
+    previewMaxEntries_ = maxEntries;
+    previewMaxBytesPerFile_ = maxBytesPerFile;
+
+    // cached previews may be too long now. start over with a new loader
+    previewLoader_.reset();
+    previewRequest_.clear();
+}
+
+inline void ImGui::FileBrowser::SetSharedListingCacheCapacity(size_t maxEntries, size_t maxBytes)
+{
+    SharedListingCache::GetInstance().SetCapacity(maxEntries, maxBytes);
+}
+
+inline std::string ImGui::FileBrowser::ToLower(const std::string &s)
+{
+    std::string ret = s;
+    for(char &c : ret)
+    {
+        c = static_cast<char>(std::tolower(c));
+    }
+    return ret;
+}
+
+inline double ImGui::FileBrowser::GetMillisecondsSince(std::chrono::steady_clock::time_point start) noexcept
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline void ImGui::FileBrowser::RecordFrameTime(double milliseconds) noexcept
+{
+    frameTimeSamples_[frameTimeSampleCount_ % FRAME_TIME_SAMPLE_COUNT] = static_cast<float>(milliseconds);
+    ++frameTimeSampleCount_;
+}
+
+inline double ImGui::FileBrowser::GetFrameTimePercentile(double percentile) const
+{
+    const size_t count = (std::min)(frameTimeSampleCount_, FRAME_TIME_SAMPLE_COUNT);
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    std::array<float, FRAME_TIME_SAMPLE_COUNT> samples;
+    std::copy_n(frameTimeSamples_.begin(), count, samples.begin());
+    const size_t rank = (std::min)(static_cast<size_t>(percentile * static_cast<double>(count)), count - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.begin() + count);
+    return samples[rank];
+}
+
+inline void ImGui::FileBrowser::ToolTip(const std::string_view &s)
+{
+    if (!ImGui::IsItemHovered())
+    {
+        return;
+    }
+    ImGui::SetTooltip("%s", s.data());
+}
+
+inline bool ImGui::FileBrowser::BuildFileRecord(
+    const std::filesystem::directory_entry &entry, ImGuiFileBrowserFlags flags,
+    FileRecordTable &records, EnumerationStats &stats)
+{
+    ++stats.scannedCount;
+    try
+    {
+        bool isDir;
+        if(entry.is_regular_file())
+        {
+            isDir = false;
+        }
+        else if(entry.is_directory())
+        {
+            isDir = true;
+        }
+        else
+        {
+            return false;
+        }
+
+        const std::string name = u8StrToStr(entry.path().filename().u8string());
+        if(name.empty())
+        {
+            return false;
+        }
+
+        records.Add(isDir, name);
+    }
+    catch(...)
+    {
+        if(!(flags & ImGuiFileBrowserFlags_SkipItemsCausingError))
+        {
+            throw;
+        }
+        ++stats.skippedCount;
+        return false;
+    }
+    return true;
+}
+
+inline bool ImGui::FileBrowser::CompareFileRecords(
+    bool lIsDir, std::string_view lKey, std::string_view lName,
+    bool rIsDir, std::string_view rKey, std::string_view rName) noexcept
+{
+    // directories first
+    if(lIsDir != rIsDir)
+    {
+        return lIsDir;
+    }
+
+    // The default lexicographical order does not meet our sorting requirements.
+    // We want [b0, a0, A1] to be sorted into something like [a0, A1, b0] instead of [a0, b0, A1],
+    // which is what comparing case-folded keys does
+    if(const int order = lKey.compare(rKey); order != 0)
+    {
+        return order < 0;
+    }
+
+    // names with equal keys only differ in case (or leading zeros). each byte is mapped to a rank where
+    // an upper-case letter comes right after its lower-case counterpart
+    auto rank = [](char c)
+    {
+        const auto u = static_cast<unsigned char>(c);
+        return ('A' <= u && u <= 'Z') ? 2u * (u + 'a' - 'A') + 1u : 2u * u;
+    };
+
+    return std::lexicographical_compare(
+        lName.begin(), lName.end(), rName.begin(), rName.end(), [&](char l, char r)
+        {
+            return rank(l) < rank(r);
+        });
+}
+
+inline bool ImGui::FileBrowser::CompareFileRecords(
+    const FileRecordTable &records, uint32_t lhs, uint32_t rhs) noexcept
+{
+    return CompareFileRecords(records, lhs, records, rhs);
+}
+
+inline bool ImGui::FileBrowser::CompareFileRecords(
+    const FileRecordTable &lRecords, size_t lhs, const FileRecordTable &rRecords, size_t rhs) noexcept
+{
+    return CompareFileRecords(
+        lRecords.IsDir(lhs), lRecords.GetCollationKey(lhs), lRecords.GetName(lhs),
+        rRecords.IsDir(rhs), rRecords.GetCollationKey(rhs), rRecords.GetName(rhs));
+}
+
+inline size_t ImGui::FileBrowser::LowerBoundFileRecord(
+    const FileRecordTable &records, bool isDir, std::string_view name)
+{
+    std::string key;
+    FileRecordTable::AppendCollationKey(key, name, records.IsNaturalOrder());
+
+    // binary search in [1, size). '..' is always the first record
+    size_t first = 1, count = records.Size() > 1 ? records.Size() - 1 : 0;
+    while(count > 0)
+    {
+        const size_t step = count / 2;
+        const size_t mid = first + step;
+        if(CompareFileRecords(records.IsDir(mid), records.GetCollationKey(mid), records.GetName(mid), isDir, key, name))
+        {
+            first = mid + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
+
+inline size_t ImGui::FileBrowser::FindFileRecord(
+    const FileRecordTable &records, bool isDir, std::string_view name)
+{
+    const size_t index = LowerBoundFileRecord(records, isDir, name);
+    if(index < records.Size() && records.IsDir(index) == isDir && records.GetName(index) == name)
+    {
+        return index;
+    }
+    return records.Size();
+}
+
+template <class Func>
+void ImGui::FileBrowser::ParallelForChunks(size_t begin, size_t end, size_t chunkCount, const Func &func)
+{
+    const size_t count = end - begin;
+    auto chunkBegin = [&](size_t chunkIndex)
+    {
+        return begin + count * chunkIndex / chunkCount;
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunkCount - 1);
+    for(size_t i = 1; i < chunkCount; ++i)
+    {
+        threads.emplace_back([&, i] { func(i, chunkBegin(i), chunkBegin(i + 1)); });
+    }
+
+    // the calling thread handles the first chunk
+    func(0, chunkBegin(0), chunkBegin(1));
+
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+inline void ImGui::FileBrowser::SortFileRecords(FileRecordTable &records, size_t parallelSortThreshold)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::SortFileRecords");
+
+    SortFileRecordsInChunks(
+        records, records.Size() < parallelSortThreshold ? 1 : GetParallelSortChunkCount(records.Size()));
+}
+
+inline size_t ImGui::FileBrowser::GetParallelSortChunkCount(size_t recordCount) noexcept
+{
+    constexpr size_t MIN_CHUNK_SIZE = 8192;
+    const size_t hardwareThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+    return (std::max)(static_cast<size_t>(1), (std::min)(hardwareThreadCount, recordCount / MIN_CHUNK_SIZE));
+}
+
+inline void ImGui::FileBrowser::SortFileRecordsInChunks(FileRecordTable &records, size_t chunkCount)
+{
+    if(records.Size() <= 2)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> fileRecordRemapIndices(records.Size());
+    std::iota(fileRecordRemapIndices.begin(), fileRecordRemapIndices.end(), 0u);
+
+    auto compare = [&](uint32_t li, uint32_t ri)
+    {
+        return CompareFileRecords(records, li, ri);
+    };
+
+    // keep '..' at the beginning. every chunk holds at least one record
+    chunkCount = (std::min)(chunkCount, records.Size() - 1);
+    if(chunkCount <= 1)
+    {
+        std::sort(fileRecordRemapIndices.begin() + 1, fileRecordRemapIndices.end(), compare);
+        records.Permute(fileRecordRemapIndices);
+        return;
+    }
+
+    // sort chunks in parallel, then k-way merge them
+    std::vector<std::pair<size_t, size_t>> chunks(chunkCount);
+    ParallelForChunks(1, fileRecordRemapIndices.size(), chunkCount, [&](size_t chunkIndex, size_t begin, size_t end)
+    {
+        std::sort(fileRecordRemapIndices.begin() + begin, fileRecordRemapIndices.begin() + end, compare);
+        chunks[chunkIndex] = { begin, end };
+    });
+
+    // heap of unfinished chunks ordered by their first remaining record
+    auto chunkGreater = [&](const std::pair<size_t, size_t> &l, const std::pair<size_t, size_t> &r)
+    {
+        return compare(fileRecordRemapIndices[r.first], fileRecordRemapIndices[l.first]);
+    };
+    std::make_heap(chunks.begin(), chunks.end(), chunkGreater);
+
+    std::vector<uint32_t> mergedIndices;
+    mergedIndices.reserve(fileRecordRemapIndices.size());
+    mergedIndices.push_back(0);
+    while(!chunks.empty())
+    {
+        std::pop_heap(chunks.begin(), chunks.end(), chunkGreater);
+        auto &chunk = chunks.back();
+        mergedIndices.push_back(fileRecordRemapIndices[chunk.first++]);
+        if(chunk.first == chunk.second)
+        {
+            chunks.pop_back();
+        }
+        else
+        {
+            std::push_heap(chunks.begin(), chunks.end(), chunkGreater);
+        }
+    }
+
+    records.Permute(mergedIndices);
+}
+
+inline void ImGui::FileBrowser::EnumerateFileRecordsAsync(
+    std::filesystem::directory_iterator it, ImGuiFileBrowserFlags flags,
+    size_t parallelSortThreshold, AsyncEnumeration *state)
+{
+    ScopeGuard markExited([state] { state->exited = true; });
+
+    FileRecordTable records(flags & ImGuiFileBrowserFlags_NaturalOrder);
+    records.Add(true, "..");
+    size_t publishedCount = 1;
+
+    auto publish = [&]
+    {
+        std::lock_guard lock(state->mutex);
+        state->staging.Append(records, publishedCount, records.Size());
+        publishedCount = records.Size();
+    };
+
+    EnumerationStats stats;
+    auto startTime = std::chrono::steady_clock::now();
+
+    try
+    {
+        {
+            IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::EnumerateDirectory");
+            for(auto &p : it)
+            {
+                if(state->cancelled.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                if(BuildFileRecord(p, flags, records, stats) && !state->isRefresh &&
+                   records.Size() - publishedCount >= AsyncEnumeration::BATCH_SIZE)
+                {
+                    publish();
+                }
+            }
+        }
+
+        if(state->cancelled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        if(!state->isRefresh)
+        {
+            publish();
+        }
+        stats.enumerationMs = GetMillisecondsSince(startTime);
+
+        startTime = std::chrono::steady_clock::now();
+        SortFileRecords(records, parallelSortThreshold);
+        stats.sortMs = GetMillisecondsSince(startTime);
+        if(state->cancelled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        std::lock_guard lock(state->mutex);
+        state->result = std::move(records);
+        state->stats = stats;
+        state->finished = true;
+    }
+    catch(...)
+    {
+        std::lock_guard lock(state->mutex);
+        state->error = std::current_exception();
+        state->finished = true;
+    }
+}
+
+inline void ImGui::FileBrowser::SearchSubtree(
+    RecursiveSearch search, size_t parallelSortThreshold, AsyncEnumeration *state)
+{
+    ScopeGuard markExited([state] { state->exited = true; });
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::SearchSubtree");
+
+    const bool naturalOrder = search.flags & ImGuiFileBrowserFlags_NaturalOrder;
+    const bool wantDir = search.flags & ImGuiFileBrowserFlags_SelectDirectory;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // symlinks to directories inside the root are skipped since their targets are reached anyway. other targets
+    // are searched at most once, which breaks cycles
+    std::error_code rootEc;
+    const std::filesystem::path rootTarget = std::filesystem::canonical(search.root, rootEc);
+    std::mutex visitedTargetsMutex;
+    std::set<std::filesystem::path> visitedTargets;
+    auto shouldEnterSymlink = [&](const std::filesystem::path &link)
+    {
+        std::error_code ec;
+        const std::filesystem::path target = std::filesystem::canonical(link, ec);
+        if(ec || rootEc)
+        {
+            return false;
+        }
+        if(std::mismatch(rootTarget.begin(), rootTarget.end(), target.begin(), target.end()).first == rootTarget.end())
+        {
+            return false;
+        }
+        std::lock_guard lock(visitedTargetsMutex);
+        return visitedTargets.insert(target).second;
+    };
+
+    const size_t workerCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+    std::vector<RecursiveSearch::TaskQueue> queues(workerCount);
+    std::vector<FileRecordTable> results(workerCount, FileRecordTable(naturalOrder));
+    queues[0].tasks.push_back({ search.root, std::string(), 0 });
+
+    // tasks queued or being processed. a task is counted before its parent is done, so the search is over once
+    // this drops to 0
+    std::atomic<size_t> taskCount = 1;
+    std::atomic<size_t> matchCount = 0;
+    std::atomic<size_t> scannedCount = 0;
+    std::atomic<bool>   isTruncated = false;
+
+    auto shouldStop = [&]
+    {
+        return state->cancelled.load(std::memory_order_relaxed) || isTruncated.load(std::memory_order_relaxed);
+    };
+
+    // workers without tasks sleep on idleCondition. it is signalled when a task is queued while any worker is
+    // idle, and when the search is over. cancellation by the ui thread isn't signalled, so idle workers also
+    // wake up every CANCEL_CHECK_INTERVAL to check it
+    constexpr std::chrono::milliseconds CANCEL_CHECK_INTERVAL{ 10 };
+    std::mutex              idleMutex;
+    std::condition_variable idleCondition;
+    std::atomic<size_t>     idleWorkerCount = 0;
+
+    auto wakeIdleWorkers = [&](bool all)
+    {
+        // locking idleMutex makes sure that a worker which has just found no task is already waiting
+        {
+            std::lock_guard lock(idleMutex);
+        }
+        if(all)
+        {
+            idleCondition.notify_all();
+        }
+        else
+        {
+            idleCondition.notify_one();
+        }
+    };
+
+    auto hasQueuedTask = [&]
+    {
+        return std::any_of(queues.begin(), queues.end(), [](RecursiveSearch::TaskQueue &queue)
+        {
+            std::lock_guard lock(queue.mutex);
+            return !queue.tasks.empty();
+        });
+    };
+
+    auto popTask = [&](size_t worker, RecursiveSearch::Task &task)
+    {
+        for(size_t i = 0; i < workerCount; ++i)
+        {
+            auto &queue = queues[(worker + i) % workerCount];
+            std::lock_guard lock(queue.mutex);
+            if(queue.tasks.empty())
+            {
+                continue;
+            }
+
+            // own tasks are taken depth-first to keep queues short. stolen ones are the oldest, and so the largest
+            if(i == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    };
+
+    auto searchDirectory = [&](size_t worker, const RecursiveSearch::Task &task)
+    {
+        auto &records = results[worker];
+        std::string scratch;
+        std::error_code ec;
+        std::filesystem::directory_iterator it(
+            task.directory, std::filesystem::directory_options::skip_permission_denied, ec);
+        for(; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            if(shouldStop())
+            {
+                return;
+            }
+            ++scannedCount;
+
+            const auto &entry = *it;
+            std::error_code entryEc;
+            const bool isDir = entry.is_directory(entryEc);
+            const bool isFile = !entryEc && !isDir && entry.is_regular_file(entryEc);
+            if(entryEc || (!isDir && !isFile))
+            {
+                continue;
+            }
+
+            const std::string name = u8StrToStr(entry.path().filename().u8string());
+            if(name.empty())
+            {
+                continue;
+            }
+
+            if(isDir == wantDir && IsSearchMatched(name, search.query) &&
+               (!search.typeFilter ||
+                search.typeFilter->IsMatched(name, u8StrToStr(entry.path().extension().u8string()), scratch)))
+            {
+                if(++matchCount > search.options.maxResultCount)
+                {
+                    isTruncated = true;
+                    return;
+                }
+                records.Add(isDir, task.relativePath + name);
+            }
+
+            if(!isDir || task.depth >= search.options.maxDepth)
+            {
+                continue;
+            }
+            const auto &excluded = search.options.excludedDirectories;
+            if(std::find(excluded.begin(), excluded.end(), name) != excluded.end())
+            {
+                continue;
+            }
+            const bool isSymlink = entry.is_symlink(entryEc);
+            if(entryEc || (isSymlink && !(search.options.followSymlinks && shouldEnterSymlink(entry.path()))))
+            {
+                continue;
+            }
+
+            ++taskCount;
+            {
+                std::lock_guard lock(queues[worker].mutex);
+                queues[worker].tasks.push_back({ entry.path(), task.relativePath + name + '/', task.depth + 1 });
+            }
+            if(idleWorkerCount.load() > 0)
+            {
+                wakeIdleWorkers(false);
+            }
+        }
+    };
+
+    try
+    {
+        ParallelForChunks(0, workerCount, workerCount, [&](size_t worker, size_t, size_t)
+        {
+            auto &records = results[worker];
+            size_t publishedCount = 0;
+            RecursiveSearch::Task task;
+            while(!shouldStop())
+            {
+                if(!popTask(worker, task))
+                {
+                    std::unique_lock lock(idleMutex);
+                    ++idleWorkerCount;
+                    idleCondition.wait_for(lock, CANCEL_CHECK_INTERVAL, [&]
+                    {
+                        return taskCount.load() == 0 || shouldStop() || hasQueuedTask();
+                    });
+                    --idleWorkerCount;
+                    if(taskCount.load() == 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+
+                // a directory failing halfway only loses its remaining entries
+                try
+                {
+                    searchDirectory(worker, task);
+                }
+                catch(...)
+                {
+                }
+                if(--taskCount == 0 || isTruncated.load(std::memory_order_relaxed))
+                {
+                    wakeIdleWorkers(true);
+                }
+
+                if(records.Size() > publishedCount)
+                {
+                    std::lock_guard lock(state->mutex);
+                    state->staging.Append(records, publishedCount, records.Size());
+                    publishedCount = records.Size();
+                }
+            }
+        });
+        if(state->cancelled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        FileRecordTable records(naturalOrder);
+        records.Add(true, "..");
+        for(auto &workerResults : results)
+        {
+            records.Append(workerResults, 0, workerResults.Size());
+            workerResults.Clear();
+        }
+
+        EnumerationStats stats;
+        stats.scannedCount = scannedCount;
+        stats.enumerationMs = GetMillisecondsSince(startTime);
+
+        const auto sortStartTime = std::chrono::steady_clock::now();
+        SortFileRecords(records, parallelSortThreshold);
+        stats.sortMs = GetMillisecondsSince(sortStartTime);
+
+        std::lock_guard lock(state->mutex);
+        state->result = std::move(records);
+        state->stats = stats;
+        state->finished = true;
+    }
+    catch(...)
+    {
+        std::lock_guard lock(state->mutex);
+        state->error = std::current_exception();
+        state->finished = true;
+    }
+}
+
+inline std::filesystem::file_time_type ImGui::FileBrowser::GetLastWriteTime(
+    const std::filesystem::path &path) noexcept
+{
+    std::error_code ec;
+    const auto ret = last_write_time(path, ec);
+    return ec ? std::filesystem::file_time_type::min() : ret;
+}
+
+inline void ImGui::FileBrowser::UpdateFileRecords(bool isNavigation)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::UpdateFileRecords");
+    CancelEnumeration();
+    fileRecords_.Clear();
+    fileRecords_.Add(true, "..");
+    ResetRecordCaches();
+    selectedRecords_.Reset();
+    selectedRecords_.Resize(fileRecords_.Size());
+    visibleRecordIndicesDirty_ = true;
+
+    // queried before enumerating so that any change made during the enumeration invalidates the cached listing.
+    // fileRecordsWriteTime_ is only set when the enumeration succeeds, so that partial listings are never cached
+    WatchCurrentDirectory();
+    const auto lastWriteTime = GetLastWriteTime(currentDirectory_);
+    fileRecordsWriteTime_ = std::filesystem::file_time_type::min();
+
+    // opening the directory is done here so that errors like 'permission denied' still
+    // reach SetCurrentDirectoryInternal and trigger the fallback logic
+    std::filesystem::directory_iterator it(currentDirectory_);
+
+    // part of a burst of navigations. wait for the last one. synchronous SetDirectory always returns with the
+    // listing loaded, even when the browser is not displayed
+    const auto now = std::chrono::steady_clock::now();
+    if(isNavigation && (flags_ & ImGuiFileBrowserFlags_AsyncEnumeration) &&
+       now - lastNavigationTime_ < navigationDebounceTime_)
+    {
+        lastNavigationTime_ = now;
+        hasPendingEnumeration_ = true;
+        pendingIterator_ = std::move(it);
+        pendingWriteTime_ = lastWriteTime;
+        ClearRangeSelectionState();
+        return;
+    }
+
+    EnumerateFileRecords(std::move(it), lastWriteTime);
+    if(isNavigation)
+    {
+        lastNavigationTime_ = std::chrono::steady_clock::now();
+    }
+}
+
+inline void ImGui::FileBrowser::EnumerateFileRecords(
+    std::filesystem::directory_iterator it, std::filesystem::file_time_type lastWriteTime)
+{
+    if(flags_ & ImGuiFileBrowserFlags_AsyncEnumeration)
+    {
+        StartAsyncEnumeration(std::move(it), false, lastWriteTime);
+        ClearRangeSelectionState();
+        return;
+    }
+
+    EnumerationStats stats;
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::EnumerateDirectory");
+        for(auto &p : it)
+        {
+            BuildFileRecord(p, flags_, fileRecords_, stats);
+        }
+    }
+    stats.enumerationMs = GetMillisecondsSince(startTime);
+
+    startTime = std::chrono::steady_clock::now();
+    SortFileRecords(fileRecords_, parallelSortThreshold_);
+    stats.sortMs = GetMillisecondsSince(startTime);
+
+    lastEnumerationStats_ = stats;
+    selectedRecords_.Resize(fileRecords_.Size());
+    fileRecordsWriteTime_ = lastWriteTime;
+    ClearRangeSelectionState();
+    ShareCurrentListing();
+}
+
+inline void ImGui::FileBrowser::StartAsyncEnumeration(
+    std::filesystem::directory_iterator it, bool isRefresh, std::filesystem::file_time_type lastWriteTime)
+{
+    CancelEnumeration();
+    asyncEnumeration_ = std::make_unique<AsyncEnumeration>();
+    asyncEnumeration_->staging = FileRecordTable(flags_ & ImGuiFileBrowserFlags_NaturalOrder);
+    asyncEnumeration_->isRefresh = isRefresh;
+    asyncEnumeration_->lastWriteTime = lastWriteTime;
+    asyncEnumeration_->worker = std::thread(
+        EnumerateFileRecordsAsync, std::move(it), flags_, parallelSortThreshold_, asyncEnumeration_.get());
+}
+
+inline void ImGui::FileBrowser::CancelEnumeration()
+{
+    hasPendingEnumeration_ = false;
+    pendingIterator_ = std::filesystem::directory_iterator();
+
+    // joining would block the ui until the worker notices the cancellation, which takes a while if it is
+    // sorting a huge directory. keep it aside and destroy it once it has exited
+    if(asyncEnumeration_)
+    {
+        asyncEnumeration_->cancelled = true;
+        cancelledEnumerations_.push_back(std::move(asyncEnumeration_));
+    }
+}
+
+inline void ImGui::FileBrowser::PollPendingEnumeration()
+{
+    cancelledEnumerations_.remove_if([](const std::unique_ptr<AsyncEnumeration> &enumeration)
+    {
+        return enumeration->exited.load();
+    });
+
+    if(hasPendingRecursiveSearch_ && std::chrono::steady_clock::now() - lastSearchEditTime_ >= navigationDebounceTime_)
+    {
+        StartRecursiveSearch();
+    }
+
+    if(!hasPendingEnumeration_ || std::chrono::steady_clock::now() - lastNavigationTime_ < navigationDebounceTime_)
+    {
+        return;
+    }
+
+    hasPendingEnumeration_ = false;
+    auto it = std::move(pendingIterator_);
+    pendingIterator_ = std::filesystem::directory_iterator();
+    try
+    {
+        EnumerateFileRecords(std::move(it), pendingWriteTime_);
+    }
+    catch(...)
+    {
+        HandleEnumerationError(std::current_exception());
+    }
+    lastNavigationTime_ = std::chrono::steady_clock::now();
+}
+
+inline void ImGui::FileBrowser::HandleEnumerationError(const std::exception_ptr &error)
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch(const std::exception &err)
+    {
+        statusStr_ = std::string("error: ") + err.what();
+    }
+    catch(...)
+    {
+        statusStr_ = "unknown error";
+    }
+
+    // enumeration failed halfway. fall back to the default directory like SetCurrentDirectoryInternal
+    if(currentDirectory_ != absolute(defaultDirectory_))
+    {
+        SetDirectory(defaultDirectory_);
+    }
+}
+
+inline void ImGui::FileBrowser::UpdateRecursiveSearch()
+{
+    const bool shouldSearch =
+        recursiveSearch_ && (flags_ & ImGuiFileBrowserFlags_RecursiveSearch) &&
+        searchQuery_.find_first_not_of(' ') != std::string::npos;
+    if(shouldSearch)
+    {
+        // every key typed into the search box changes the query. search for the last one only
+        hasPendingRecursiveSearch_ = true;
+        lastSearchEditTime_ = std::chrono::steady_clock::now();
+        return;
+    }
+
+    hasPendingRecursiveSearch_ = false;
+    StopRecursiveSearch();
+}
+
+inline void ImGui::FileBrowser::StartRecursiveSearch()
+{
+    hasPendingRecursiveSearch_ = false;
+    if(!isRecursiveSearchActive_)
+    {
+        CacheCurrentListing();
+    }
+
+    CancelEnumeration();
+    isRecursiveSearchActive_ = true;
+    fileRecords_.Clear();
+    fileRecords_.Add(true, "..");
+    ResetRecordCaches();
+    selectedRecords_.Reset();
+    selectedRecords_.Resize(fileRecords_.Size());
+    visibleRecordIndicesDirty_ = true;
+    ClearRangeSelectionState();
+
+    // results are never put into the listing cache
+    fileRecordsWriteTime_ = std::filesystem::file_time_type::min();
+
+    RecursiveSearch search;
+    search.root = currentDirectory_;
+    search.query = searchQuery_;
+    search.flags = flags_;
+    search.options = recursiveSearchOptions_;
+    if(typeFilterIndex_ < typeFilters_.size() && typeFilters_[typeFilterIndex_] != std::string_view(".*"))
+    {
+        search.typeFilter = std::make_unique<TypeFilterMatcher>(typeFilterMatchers_[typeFilterIndex_]);
+    }
+
+    asyncEnumeration_ = std::make_unique<AsyncEnumeration>();
+    asyncEnumeration_->staging = FileRecordTable(flags_ & ImGuiFileBrowserFlags_NaturalOrder);
+    asyncEnumeration_->lastWriteTime = std::filesystem::file_time_type::min();
+    asyncEnumeration_->worker = std::thread(
+        SearchSubtree, std::move(search), parallelSortThreshold_, asyncEnumeration_.get());
+}
+
+inline void ImGui::FileBrowser::StopRecursiveSearch()
+{
+    if(!isRecursiveSearchActive_)
+    {
+        return;
+    }
+
+    CancelEnumeration();
+    isRecursiveSearchActive_ = false;
+    try
+    {
+        if(!LoadCachedListing())
+        {
+            UpdateFileRecords();
+        }
+    }
+    catch(...)
+    {
+        HandleEnumerationError(std::current_exception());
+    }
+}
+
+inline void ImGui::FileBrowser::PollAsyncEnumeration()
+{
+    if(!asyncEnumeration_)
+    {
+        return;
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(asyncEnumeration_->mutex);
+
+        auto &staging = asyncEnumeration_->staging;
+        if(!asyncEnumeration_->finished)
+        {
+            if(staging.Size())
+            {
+                // only the new batch is filtered. the view is rebuilt once the enumeration has finished and
+                // the records are sorted
+                const size_t begin = fileRecords_.Size();
+                fileRecords_.Append(staging, 0, staging.Size());
+                selectedRecords_.Resize(fileRecords_.Size());
+                staging.Clear();
+                if(!visibleRecordIndicesDirty_)
+                {
+                    AppendVisibleRecordIndices(begin);
+                }
+            }
+            return;
+        }
+
+        error = asyncEnumeration_->error;
+    }
+
+    // the worker has finished. no need to lock anymore
+    const auto enumeration = std::move(asyncEnumeration_);
+    if(!error)
+    {
+        if(enumeration->isRefresh)
+        {
+            MergeRefreshedFileRecords(std::move(enumeration->result));
+        }
+        else
+        {
+            // records picked by the user during the enumeration are moved by sorting
+            const FileRecordTable streamedRecords = std::move(fileRecords_);
+            const RecordBitset streamedSelection = selectedRecords_;
+
+            fileRecords_ = std::move(enumeration->result);
+            ResetRecordCaches();
+            visibleRecordIndicesDirty_ = true;
+            RestoreSelectionByName(streamedRecords, streamedSelection);
+            ClearRangeSelectionState();
+        }
+        fileRecordsWriteTime_ = enumeration->lastWriteTime;
+        lastEnumerationStats_ = enumeration->stats;
+        ShareCurrentListing();
+    }
+
+    if(error)
+    {
+        HandleEnumerationError(error);
+    }
+}
+
+inline ImGui::FileBrowser::AsyncEnumeration::~AsyncEnumeration()
+{
+    cancelled = true;
+    if(worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+inline ImGui::FileBrowser::MetadataFetcher::MetadataFetcher()
+{
+    const unsigned int workerCount = (std::max)(1u, (std::min)(MAX_WORKER_COUNT, std::thread::hardware_concurrency()));
+    for(unsigned int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(FetchRecordMetadata, this);
+    }
+}
+
+inline ImGui::FileBrowser::MetadataFetcher::~MetadataFetcher()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+    condition.notify_all();
+    for(auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+inline void ImGui::FileBrowser::FetchRecordMetadata(MetadataFetcher *fetcher)
+{
+    std::unique_lock lock(fetcher->mutex);
+    while(true)
+    {
+        fetcher->condition.wait(lock, [&]
+        {
+            return fetcher->stopped || !fetcher->requests.empty() || !fetcher->backgroundRequests.empty();
+        });
+        if(fetcher->stopped)
+        {
+            return;
+        }
+
+        auto &queue = !fetcher->requests.empty() ? fetcher->requests : fetcher->backgroundRequests;
+        const auto request = std::move(queue.front());
+        queue.pop_front();
+
+        lock.unlock();
+        const RecordMetadata metadata = QueryRecordMetadata(request.path);
+        lock.lock();
+
+        fetcher->results.push_back({ request.generation, request.recordIndex, metadata });
+    }
+}
+
+inline ImGui::FileBrowser::RecordMetadata ImGui::FileBrowser::QueryRecordMetadata(const std::filesystem::path &path)
+{
+    RecordMetadata ret;
+    ret.state = RecordMetadata::State_Failed;
+
+    std::error_code ec;
+    const std::filesystem::directory_entry entry(path, ec);
+    if(ec)
+    {
+        return ret;
+    }
+
+    const auto status = entry.status(ec);
+    if(ec)
+    {
+        return ret;
+    }
+    ret.permissions = status.permissions();
+
+    if(std::filesystem::is_regular_file(status))
+    {
+        ret.size = entry.file_size(ec);
+        if(ec)
+        {
+            return ret;
+        }
+    }
+
+    const auto lastWriteTime = entry.last_write_time(ec);
+    if(ec)
+    {
+        return ret;
+    }
+    ret.modifiedTime = ToTimeT(lastWriteTime);
+
+    ret.state = RecordMetadata::State_Ready;
+    return ret;
+}
+
+inline void ImGui::FileBrowser::FormatSize(uint64_t size, char *buffer, size_t bufferSize) noexcept
+{
+    const char *units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    double scaledSize = static_cast<double>(size);
+    size_t unit = 0;
+    while(scaledSize >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0]))
+    {
+        scaledSize /= 1024;
+        ++unit;
+    }
+    if(unit == 0)
+    {
+        std::snprintf(buffer, bufferSize, "%llu B", static_cast<unsigned long long>(size));
+    }
+    else
+    {
+        std::snprintf(buffer, bufferSize, "%.1f %s", scaledSize, units[unit]);
+    }
+}
+
+inline ImGui::FileBrowser::DirectorySizeCalculator::DirectorySizeCalculator()
+{
+    const unsigned int workerCount = (std::max)(1u, (std::min)(MAX_WORKER_COUNT, std::thread::hardware_concurrency()));
+    for(unsigned int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(CalculateDirectorySizes, this);
+    }
+}
+
+inline ImGui::FileBrowser::DirectorySizeCalculator::~DirectorySizeCalculator()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+    condition.notify_all();
+    for(auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+inline void ImGui::FileBrowser::CalculateDirectorySizes(DirectorySizeCalculator *calculator)
+{
+    LowerCurrentThreadPriority();
+
+    std::unique_lock lock(calculator->mutex);
+    while(true)
+    {
+        calculator->condition.wait(lock, [&] { return calculator->stopped || !calculator->tasks.empty(); });
+        if(calculator->stopped)
+        {
+            return;
+        }
+
+        const auto task = std::move(calculator->tasks.back());
+        calculator->tasks.pop_back();
+
+        lock.unlock();
+        try
+        {
+            WalkDirectorySize(calculator, task);
+        }
+        catch(...)
+        {
+            // the root stays partial. its size is never cached
+        }
+        lock.lock();
+    }
+}
+
+inline void ImGui::FileBrowser::WalkDirectorySize(
+    DirectorySizeCalculator *calculator, const DirectorySizeCalculator::Task &task)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::WalkDirectorySize");
+
+    DirectorySizeJob &job = *task.job;
+    DirectorySizeJob::Root &root = job.roots[task.rootIndex];
+
+    auto finishDirectory = [&]
+    {
+        if(--root.pendingCount != 0)
+        {
+            return;
+        }
+        if(!root.hasErrors && !root.identity.empty() && root.lastWriteTime != std::filesystem::file_time_type::min())
+        {
+            std::lock_guard lock(calculator->mutex);
+            auto &cacheOrder = calculator->cacheOrder;
+            const auto [it, isInserted] = calculator->cache.try_emplace(root.identity);
+            if(isInserted)
+            {
+                cacheOrder.push_front(root.identity);
+                it->second.order = cacheOrder.begin();
+            }
+            else
+            {
+                cacheOrder.splice(cacheOrder.begin(), cacheOrder, it->second.order);
+            }
+            it->second.lastWriteTime = root.lastWriteTime;
+            it->second.size = root.size;
+
+            if(calculator->cache.size() > DirectorySizeCalculator::MAX_CACHE_SIZE)
+            {
+                calculator->cache.erase(cacheOrder.back());
+                cacheOrder.pop_back();
+            }
+        }
+        root.isDone = true;
+        --job.pendingRootCount;
+    };
+
+    const bool isRoot = task.directory.empty();
+    if(isRoot)
+    {
+        // a directory keeps its identity and modification time unless entries are added, removed or renamed in it
+        root.lastWriteTime = GetLastWriteTime(root.path);
+        root.identity = GetDirectoryIdentity(root.path);
+
+        std::unique_lock lock(calculator->mutex);
+        const auto it = calculator->cache.find(root.identity);
+        if(!root.identity.empty() && it != calculator->cache.end() && it->second.lastWriteTime == root.lastWriteTime)
+        {
+            calculator->cacheOrder.splice(calculator->cacheOrder.begin(), calculator->cacheOrder, it->second.order);
+            root.size = it->second.size;
+            lock.unlock();
+            finishDirectory();
+            return;
+        }
+    }
+
+    // symlinks are neither followed nor counted, which also rules out cycles
+    uint64_t size = 0;
+    std::vector<std::filesystem::path> subdirectories;
+    std::error_code ec;
+    std::filesystem::directory_iterator it(
+        isRoot ? root.path : task.directory, std::filesystem::directory_options::skip_permission_denied, ec);
+    for(; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+    {
+        if(job.cancelled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        std::error_code entryEc;
+        const auto status = it->symlink_status(entryEc);
+        if(entryEc)
+        {
+            continue;
+        }
+        if(std::filesystem::is_directory(status))
+        {
+            subdirectories.push_back(it->path());
+        }
+        else if(std::filesystem::is_regular_file(status))
+        {
+            const uint64_t fileSize = it->file_size(entryEc);
+            size += entryEc ? 0 : fileSize;
+        }
+    }
+
+    // the size of a cancelled root is never complete
+    if(job.cancelled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    if(ec)
+    {
+        root.hasErrors = true;
+    }
+
+    root.size += size;
+    if(!subdirectories.empty())
+    {
+        root.pendingCount += subdirectories.size();
+        std::lock_guard lock(calculator->mutex);
+        for(auto &subdirectory : subdirectories)
+        {
+            calculator->tasks.push_back({ task.job, task.rootIndex, std::move(subdirectory) });
+        }
+        calculator->condition.notify_all();
+    }
+    finishDirectory();
+}
+
+inline std::string ImGui::FileBrowser::GetDirectoryIdentity(const std::filesystem::path &dir)
+{
+#ifdef _WIN32
+    // file ids need an opened handle on windows. the canonical path is good enough
+    std::error_code ec;
+    const std::filesystem::path canonicalDir = std::filesystem::canonical(dir, ec);
+    return ec ? std::string() : u8StrToStr(canonicalDir.u8string());
+#else
+    struct stat status;
+    if(stat(dir.c_str(), &status) != 0)
+    {
+        return std::string();
+    }
+    return std::to_string(status.st_dev) + ':' + std::to_string(status.st_ino);
+#endif
+}
+
+inline ImGui::FileBrowser::PreviewLoader::PreviewLoader(size_t cacheCapacity, size_t maxFileBytes)
+    : maxEntries(cacheCapacity), maxBytesPerFile(maxFileBytes)
+{
+    worker = std::thread(LoadPreviews, this);
+}
+
+inline ImGui::FileBrowser::PreviewLoader::~PreviewLoader()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+    condition.notify_all();
+    worker.join();
+}
+
+inline void ImGui::FileBrowser::LoadPreviews(PreviewLoader *loader)
+{
+    std::unique_lock lock(loader->mutex);
+    while(true)
+    {
+        loader->condition.wait(lock, [&] { return loader->stopped || !loader->request.empty(); });
+        if(loader->stopped)
+        {
+            return;
+        }
+
+        const std::filesystem::path path = std::move(loader->request);
+        loader->request.clear();
+
+        lock.unlock();
+        auto preview = std::make_unique<FilePreview>(LoadPreview(loader, path));
+        lock.lock();
+
+        // dropped by the ui thread if another file has been requested meanwhile
+        loader->result = std::move(preview);
+    }
+}
+
+inline ImGui::FileBrowser::FilePreview ImGui::FileBrowser::LoadPreview(
+    PreviewLoader *loader, const std::filesystem::path &path)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::LoadPreview");
+
+    FilePreview preview;
+    preview.path = path;
+
+    std::error_code ec;
+    preview.lastWriteTime = std::filesystem::last_write_time(path, ec);
+    if(!ec)
+    {
+        preview.size = std::filesystem::file_size(path, ec);
+    }
+    if(ec)
+    {
+        preview.error = ec.message();
+        return preview;
+    }
+
+    auto &cache = loader->cache;
+    const auto it = std::find_if(cache.begin(), cache.end(), [&](const FilePreview &cached)
+    {
+        return cached.path == path && cached.lastWriteTime == preview.lastWriteTime && cached.size == preview.size;
+    });
+    if(it != cache.end())
+    {
+        cache.splice(cache.begin(), cache, it);
+        return cache.front();
+    }
+
+    std::string bytes;
+    if(!ReadFileHead(path, loader->maxBytesPerFile, bytes, preview.error))
+    {
+        return preview;
+    }
+    preview.isText = IsTextContent(bytes);
+    if(preview.isText)
+    {
+        preview.contents = std::move(bytes);
+    }
+    else
+    {
+        AppendHexDump(preview.contents, bytes);
+    }
+
+    if(loader->maxEntries > 0)
+    {
+        cache.push_front(preview);
+        while(cache.size() > loader->maxEntries)
+        {
+            cache.pop_back();
+        }
+    }
+    return preview;
+}
+
+inline bool ImGui::FileBrowser::ReadFileHead(
+    const std::filesystem::path &path, size_t maxBytes, std::string &bytes, std::string &error)
+{
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+    {
+        error = "failed to open the file";
+        return false;
+    }
+    bytes.resize(maxBytes);
+    file.read(bytes.data(), static_cast<std::streamsize>(maxBytes));
+    bytes.resize(static_cast<size_t>(file.gcount()));
+    return true;
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        error = std::error_code(errno, std::generic_category()).message();
+        return false;
+    }
+    ScopeGuard closeFile([fd] { close(fd); });
+
+    // reading fifos or devices may block
+    struct stat status;
+    if(fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        error = "not a regular file";
+        return false;
+    }
+
+    const size_t length = static_cast<size_t>((std::min)(static_cast<uint64_t>(status.st_size), uint64_t(maxBytes)));
+    if(length == 0)
+    {
+        return true;
+    }
+
+    // not mapped: copying from a mapping of a file truncated by another process after fstat raises SIGBUS.
+    // a short read just returns fewer bytes
+    bytes.resize(length);
+    size_t readLength = 0;
+    while(readLength < length)
+    {
+        const ssize_t n = pread(fd, bytes.data() + readLength, length - readLength, static_cast<off_t>(readLength));
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n < 0)
+        {
+            error = std::error_code(errno, std::generic_category()).message();
+            return false;
+        }
+        if(n == 0)
+        {
+            break;
+        }
+        readLength += static_cast<size_t>(n);
+    }
+    bytes.resize(readLength);
+    return true;
+#endif
+}
+
+inline bool ImGui::FileBrowser::IsTextContent(std::string_view bytes) noexcept
+{
+    for(const char c : bytes)
+    {
+        const auto u = static_cast<unsigned char>(c);
+        if(u < 0x20 && u != '\t' && u != '\n' && u != '\r' && u != '\f' && u != '\v')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void ImGui::FileBrowser::AppendHexDump(std::string &out, std::string_view bytes)
+{
+    constexpr size_t BYTES_PER_LINE = 16;
+    char text[32];
+    for(size_t lineBegin = 0; lineBegin < bytes.size(); lineBegin += BYTES_PER_LINE)
+    {
+        std::snprintf(text, sizeof(text), "%08zx ", lineBegin);
+        out += text;
+        for(size_t i = lineBegin; i < lineBegin + BYTES_PER_LINE; ++i)
+        {
+            if(i < bytes.size())
+            {
+                std::snprintf(text, sizeof(text), " %02x", static_cast<unsigned char>(bytes[i]));
+                out += text;
+            }
+            else
+            {
+                out += "   ";
+            }
+        }
+        out += "  ";
+        for(size_t i = lineBegin; i < (std::min)(lineBegin + BYTES_PER_LINE, bytes.size()); ++i)
+        {
+            const auto u = static_cast<unsigned char>(bytes[i]);
+            out += (0x20 <= u && u < 0x7f) ? bytes[i] : '.';
+        }
+        out += '\n';
+    }
+}
+
+inline std::time_t ImGui::FileBrowser::ToTimeT(std::filesystem::file_time_type time)
+{
+    // the epoch of file_time_type is unspecified before c++20. convert through the current time of both clocks
+    const auto systemTime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        time - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+    return std::chrono::system_clock::to_time_t(systemTime);
+}
+
+inline ImGui::FileBrowser::DirectoryPrefetcher::DirectoryPrefetcher(
+    ImGuiFileBrowserFlags browserFlags, size_t maxListingBytes)
+    : flags(browserFlags), maxBytes(maxListingBytes)
+{
+    const unsigned int workerCount = (std::max)(1u, (std::min)(MAX_WORKER_COUNT, std::thread::hardware_concurrency() / 2));
+    for(unsigned int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(PrefetchDirectories, this);
+    }
+}
+
+inline ImGui::FileBrowser::DirectoryPrefetcher::~DirectoryPrefetcher()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+    condition.notify_all();
+    for(auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+inline void ImGui::FileBrowser::LowerCurrentThreadPriority() noexcept
+{
+#ifdef __linux__
+    sched_param param = {};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+inline void ImGui::FileBrowser::PrefetchDirectories(DirectoryPrefetcher *prefetcher)
+{
+    LowerCurrentThreadPriority();
+
+    std::unique_lock lock(prefetcher->mutex);
+    while(true)
+    {
+        prefetcher->condition.wait(lock, [&] { return prefetcher->stopped || !prefetcher->requests.empty(); });
+        if(prefetcher->stopped)
+        {
+            return;
+        }
+
+        CachedListing listing;
+        listing.directory = std::move(prefetcher->requests.back());
+        prefetcher->requests.pop_back();
+        prefetcher->inProgress.push_back(listing.directory);
+
+        lock.unlock();
+        const bool succeeded = PrefetchDirectory(prefetcher, listing);
+        lock.lock();
+
+        auto &inProgress = prefetcher->inProgress;
+        inProgress.erase(std::find(inProgress.begin(), inProgress.end(), listing.directory));
+        if(succeeded)
+        {
+            prefetcher->results.push_back(std::move(listing));
+        }
+    }
+}
+
+inline bool ImGui::FileBrowser::PrefetchDirectory(DirectoryPrefetcher *prefetcher, CachedListing &listing)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::PrefetchDirectory");
+    try
+    {
+        // queried before enumerating like UpdateFileRecords, so that changes made meanwhile invalidate the listing
+        listing.lastWriteTime = GetLastWriteTime(listing.directory);
+        if(listing.lastWriteTime == std::filesystem::file_time_type::min())
+        {
+            return false;
+        }
+
+        FileRecordTable records(prefetcher->flags & ImGuiFileBrowserFlags_NaturalOrder);
+        records.Add(true, "..");
+        EnumerationStats stats;
+        for(auto &p : std::filesystem::directory_iterator(listing.directory))
+        {
+            if(prefetcher->stopped.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            BuildFileRecord(p, prefetcher->flags, records, stats);
+            if(stats.scannedCount % 1024 == 0 && records.GetMemoryUsage() > prefetcher->maxBytes)
+            {
+                return false;
+            }
+        }
+
+        // a single thread is enough for prefetching
+        SortFileRecords(records, (std::numeric_limits<size_t>::max)());
+        listing.records = std::move(records);
+        return listing.records.GetMemoryUsage() <= prefetcher->maxBytes;
+    }
+    catch(...)
+    {
+        return false;
+    }
+}
+
+inline void ImGui::FileBrowser::RequestPrefetch(const std::filesystem::path &dir)
+{
+    if(dir == lastPrefetchRequest_ || listingCacheMaxEntries_ == 0)
+    {
+        return;
+    }
+    lastPrefetchRequest_ = dir;
+
+    const auto isCached = [&](const CachedListing &listing) { return listing.directory == dir; };
+    if(dir == currentDirectory_ || std::any_of(listingCache_.begin(), listingCache_.end(), isCached))
+    {
+        return;
+    }
+    if((flags_ & ImGuiFileBrowserFlags_SharedListingCache) &&
+       SharedListingCache::GetInstance().Contains(dir, fileRecords_.IsNaturalOrder()))
+    {
+        return;
+    }
+
+    // a single listing may take up to half of the cache budget
+    if(!directoryPrefetcher_)
+    {
+        directoryPrefetcher_ = std::make_unique<DirectoryPrefetcher>(flags_, listingCacheMaxBytes_ / 2);
+    }
+
+    std::lock_guard lock(directoryPrefetcher_->mutex);
+    auto &requests = directoryPrefetcher_->requests;
+    auto &inProgress = directoryPrefetcher_->inProgress;
+    if(std::find(inProgress.begin(), inProgress.end(), dir) != inProgress.end())
+    {
+        return;
+    }
+    requests.erase(std::remove(requests.begin(), requests.end(), dir), requests.end());
+    requests.push_back(dir);
+    if(requests.size() > DirectoryPrefetcher::MAX_REQUEST_COUNT)
+    {
+        requests.pop_front();
+    }
+    directoryPrefetcher_->condition.notify_one();
+}
+
+inline void ImGui::FileBrowser::PollPrefetchedListings()
+{
+    if(!directoryPrefetcher_)
+    {
+        return;
+    }
+
+    std::vector<CachedListing> results;
+    {
+        std::lock_guard lock(directoryPrefetcher_->mutex);
+        results.swap(directoryPrefetcher_->results);
+    }
+    if(results.empty())
+    {
+        return;
+    }
+
+    for(auto &listing : results)
+    {
+        // records of current directory are more up to date
+        if(listing.directory == currentDirectory_)
+        {
+            continue;
+        }
+        StoreListing(std::move(listing));
+    }
+    TrimListingCache();
+}
+
+inline void ImGui::FileBrowser::RefreshFileRecords()
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::RefreshFileRecords");
+    try
+    {
+        // search results are not a listing of current directory. search again instead
+        if(isRecursiveSearchActive_)
+        {
+            StartRecursiveSearch();
+            return;
+        }
+
+        // records of current directory are still being streamed in. just restart the enumeration
+        if(asyncEnumeration_ && !asyncEnumeration_->isRefresh)
+        {
+            UpdateFileRecords();
+            return;
+        }
+
+        // current directory hasn't been enumerated yet. the delayed enumeration will be up to date
+        if(hasPendingEnumeration_)
+        {
+            return;
+        }
+
+        const auto lastWriteTime = GetLastWriteTime(currentDirectory_);
+        if(flags_ & ImGuiFileBrowserFlags_AsyncEnumeration)
+        {
+            StartAsyncEnumeration(std::filesystem::directory_iterator(currentDirectory_), true, lastWriteTime);
+            return;
+        }
+
+        EnumerationStats stats;
+        auto startTime = std::chrono::steady_clock::now();
+        FileRecordTable newRecords(flags_ & ImGuiFileBrowserFlags_NaturalOrder);
+        newRecords.Add(true, "..");
+        {
+            IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::EnumerateDirectory");
+            for(auto &p : std::filesystem::directory_iterator(currentDirectory_))
+            {
+                BuildFileRecord(p, flags_, newRecords, stats);
+            }
+        }
+        stats.enumerationMs = GetMillisecondsSince(startTime);
+
+        startTime = std::chrono::steady_clock::now();
+        SortFileRecords(newRecords, parallelSortThreshold_);
+        stats.sortMs = GetMillisecondsSince(startTime);
+        lastEnumerationStats_ = stats;
+
+        MergeRefreshedFileRecords(std::move(newRecords));
+        fileRecordsWriteTime_ = lastWriteTime;
+        ShareCurrentListing();
+    }
+    catch(...)
+    {
+        // same fallback as a failed asynchronous refresh
+        HandleEnumerationError(std::current_exception());
+    }
+}
+
+inline void ImGui::FileBrowser::MergeRefreshedFileRecords(FileRecordTable &&newRecords)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::MergeRefreshedFileRecords");
+    // the typed filename is selected even if no such entry exists
+    const std::string_view inputName =
+        (flags_ & ImGuiFileBrowserFlags_EnterNewFilename) && !inputNameBuffer_.empty() ?
+        std::string_view(inputNameBuffer_.data()) : std::string_view();
+
+    // both listings are sorted, so a single merge pass finds all added, removed and kept entries and carries
+    // the selection of kept entries over. '..' is skipped
+    RefreshStats stats;
+    RecordBitset newSelectedRecords;
+    newSelectedRecords.Resize(newRecords.Size());
+    size_t newRangeSelectionStart = newRecords.Size();
+    size_t oldIndex = 1, newIndex = 1;
+    while(oldIndex < fileRecords_.Size() || newIndex < newRecords.Size())
+    {
+        const bool isRemoved =
+            newIndex >= newRecords.Size() ||
+            (oldIndex < fileRecords_.Size() && CompareFileRecords(fileRecords_, oldIndex, newRecords, newIndex));
+        if(isRemoved)
+        {
+            // a typed filename stays selected even if the entry is gone
+            if(selectedRecords_.Test(oldIndex) && fileRecords_.GetName(oldIndex) == inputName)
+            {
+                selectedInputName_ = u8StrToPath(fileRecords_.GetNameCStr(oldIndex));
+            }
+            ++stats.removedCount;
+            ++oldIndex;
+            continue;
+        }
+
+        const bool isAdded =
+            oldIndex >= fileRecords_.Size() ||
+            CompareFileRecords(newRecords, newIndex, fileRecords_, oldIndex);
+        if(isAdded)
+        {
+            ++stats.addedCount;
+            ++newIndex;
+            continue;
+        }
+
+        if(oldIndex == rangeSelectionStart_)
+        {
+            newRangeSelectionStart = newIndex;
+        }
+        newSelectedRecords.Set(newIndex, selectedRecords_.Test(oldIndex));
+        ++stats.keptCount;
+        ++oldIndex;
+        ++newIndex;
+    }
+
+    lastRefreshStats_ = stats;
+
+    // nothing changed. keep the old records. metadata of entries may have changed though
+    if(stats.addedCount == 0 && stats.removedCount == 0)
+    {
+        ResetRecordMetadata();
+        return;
+    }
+
+    fileRecords_ = std::move(newRecords);
+    selectedRecords_ = std::move(newSelectedRecords);
+    ResetRecordCaches();
+    visibleRecordIndicesDirty_ = true;
+    if(newRangeSelectionStart < fileRecords_.Size())
+    {
+        rangeSelectionStart_ = static_cast<unsigned int>(newRangeSelectionStart);
+    }
+    else
+    {
+        ClearRangeSelectionState();
+    }
+}
+
+inline void ImGui::FileBrowser::WatchCurrentDirectory()
+{
+    if(!(flags_ & ImGuiFileBrowserFlags_WatchDirectory))
+    {
+        return;
+    }
+
+    if(!directoryWatcher_)
+    {
+        directoryWatcher_ = std::make_unique<DirectoryWatcher>();
+#ifdef __linux__
+        directoryWatcher_->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+    auto &watcher = *directoryWatcher_;
+
+    if(watcher.directory == currentDirectory_)
+    {
+        return;
+    }
+    watcher.directory = currentDirectory_;
+    watcher.nextPollTime = std::chrono::steady_clock::now() + DirectoryWatcher::POLL_INTERVAL;
+
+#ifdef __linux__
+    if(watcher.inotifyFd >= 0)
+    {
+        if(watcher.watchDescriptor >= 0)
+        {
+            inotify_rm_watch(watcher.inotifyFd, watcher.watchDescriptor);
+        }
+
+        // events of entries created before this point are harmless duplicates of what the listing finds.
+        // each event is applied by checking the entry on disk
+        watcher.watchDescriptor = inotify_add_watch(
+            watcher.inotifyFd, currentDirectory_.c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    }
+#endif
+}
+
+inline void ImGui::FileBrowser::UpdateDirectoryWatcher()
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::UpdateDirectoryWatcher");
+
+    // the listing is incomplete. changes will be picked up once the enumeration is done.
+    // search results are refreshed by RefreshFileRecords only
+    if(asyncEnumeration_ || hasPendingEnumeration_ || isRecursiveSearchActive_)
+    {
+        return;
+    }
+
+    WatchCurrentDirectory();
+    auto &watcher = *directoryWatcher_;
+
+#ifdef __linux__
+    if(watcher.inotifyFd >= 0)
+    {
+        if(watcher.watchDescriptor >= 0)
+        {
+            // queried before draining the events, so that any change not applied below makes the listing uncacheable
+            const auto lastWriteTime = GetLastWriteTime(currentDirectory_);
+
+            // coalesce all events received since the last frame. each changed entry is applied only once
+            std::set<std::string, std::less<>> changedNames;
+            bool shouldRefresh = false;
+
+            alignas(inotify_event) char buffer[4096];
+            while(true)
+            {
+                const ssize_t len = read(watcher.inotifyFd, buffer, sizeof(buffer));
+                if(len <= 0)
+                {
+                    break;
+                }
+
+                for(ssize_t offset = 0; offset < len;)
+                {
+                    const auto event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                    if(event->mask & IN_Q_OVERFLOW)
+                    {
+                        shouldRefresh = true;
+                    }
+                    else if(event->wd != watcher.watchDescriptor)
+                    {
+                        // event of a previously watched directory
+                        continue;
+                    }
+                    else if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                    {
+                        shouldRefresh = true;
+                    }
+                    else if(event->len > 0 && event->name[0] != '\0')
+                    {
+                        changedNames.emplace(event->name);
+                    }
+                }
+            }
+
+            // any change may be an entry growing deeper inside a subdirectory, which cached totals would miss
+            if(shouldRefresh || !changedNames.empty())
+            {
+                RecalculateDirectorySizes();
+            }
+
+            if(shouldRefresh)
+            {
+                RefreshFileRecords();
+                return;
+            }
+
+            for(auto &name : changedNames)
+            {
+                ApplyDirectoryEntryChange(name);
+            }
+
+            if(!changedNames.empty())
+            {
+                fileRecordsWriteTime_ = lastWriteTime;
+            }
+            return;
+        }
+    }
+#endif
+
+    // inotify is not available. fall back to polling the last write time of current directory
+    const auto now = std::chrono::steady_clock::now();
+    if(now < watcher.nextPollTime)
+    {
+        return;
+    }
+    watcher.nextPollTime = now + DirectoryWatcher::POLL_INTERVAL;
+
+    const auto lastWriteTime = GetLastWriteTime(currentDirectory_);
+    if(lastWriteTime == std::filesystem::file_time_type::min() || lastWriteTime != fileRecordsWriteTime_)
+    {
+        RecalculateDirectorySizes();
+        RefreshFileRecords();
+    }
+}
+
+inline void ImGui::FileBrowser::ApplyDirectoryEntryChange(std::string_view name)
+{
+    // current state of the entry on disk
+    bool exists = false, isDir = false;
+    try
+    {
+        const std::filesystem::directory_entry entry(currentDirectory_ / u8StrToPath(std::string(name).c_str()));
+        if(entry.is_regular_file())
+        {
+            exists = true;
+        }
+        else if(entry.is_directory())
+        {
+            exists = true;
+            isDir = true;
+        }
+    }
+    catch(...)
+    {
+        // treat inaccessible entries as removed
+    }
+
+    // remove the outdated record. the type of the entry may have changed
+    for(const bool oldIsDir : { false, true })
+    {
+        const size_t index = FindFileRecord(fileRecords_, oldIsDir, name);
+        if(index == fileRecords_.Size())
+        {
+            continue;
+        }
+        if(exists && oldIsDir == isDir)
+        {
+            return;
+        }
+
+        // a typed filename stays selected even if the entry is gone
+        if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) && selectedRecords_.Test(index) &&
+           !inputNameBuffer_.empty() && fileRecords_.GetName(index) == inputNameBuffer_.data())
+        {
+            selectedInputName_ = u8StrToPath(fileRecords_.GetNameCStr(index));
+        }
+
+        fileRecords_.Erase(index);
+        selectedRecords_.Erase(index);
+        for(auto &matches : typeFilterMatches_)
+        {
+            if(index < matches.Size())
+            {
+                matches.Erase(index);
+            }
+        }
+        if(index < searchMatches_.Size())
+        {
+            searchMatches_.Erase(index);
+        }
+        if(index < recordMetadata_.size())
+        {
+            recordMetadata_.erase(recordMetadata_.begin() + index);
+        }
+        if(rangeSelectionStart_ < fileRecords_.Size() + 1 && index < rangeSelectionStart_)
+        {
+            --rangeSelectionStart_;
+        }
+    }
+
+    if(exists)
+    {
+        const size_t index = LowerBoundFileRecord(fileRecords_, isDir, name);
+        fileRecords_.Insert(index, isDir, name);
+        selectedRecords_.Insert(index);
+        std::string scratch;
+        for(size_t i = 0; i < typeFilterMatches_.size(); ++i)
+        {
+            auto &matches = typeFilterMatches_[i];
+            if(index <= matches.Size())
+            {
+                matches.Insert(index);
+                matches.Set(index, !isDir && typeFilterMatchers_[i].IsMatched(
+                    fileRecords_.GetName(index), fileRecords_.GetExtension(index), scratch));
+            }
+        }
+        if(index <= searchMatches_.Size())
+        {
+            searchMatches_.Insert(index);
+            searchMatches_.Set(index, IsSearchMatched(fileRecords_.GetName(index), searchQuery_));
+        }
+        if(index <= recordMetadata_.size())
+        {
+            recordMetadata_.insert(recordMetadata_.begin() + index, RecordMetadata());
+        }
+        if(rangeSelectionStart_ < fileRecords_.Size() - 1 && index <= rangeSelectionStart_)
+        {
+            ++rangeSelectionStart_;
+        }
+    }
+
+    // indices of requested metadata, directory sizes and extension ranks are outdated now
+    extensionRanks_.clear();
+    CancelDirectorySizes();
+    ++metadataGeneration_;
+    backgroundMetadataRequestCount_ = 0;
+    for(auto &metadata : recordMetadata_)
+    {
+        if(metadata.state == RecordMetadata::State_Pending)
+        {
+            metadata.state = RecordMetadata::State_Unknown;
+        }
+    }
+    if(metadataFetcher_)
+    {
+        std::lock_guard lock(metadataFetcher_->mutex);
+        metadataFetcher_->requests.clear();
+        metadataFetcher_->backgroundRequests.clear();
+    }
+
+    visibleRecordIndicesDirty_ = true;
+}
+
+inline ImGui::FileBrowser::DirectoryWatcher::~DirectoryWatcher()
+{
+#ifdef __linux__
+    if(inotifyFd >= 0)
+    {
+        close(inotifyFd);
+    }
+#endif
+}
+
+inline void ImGui::FileBrowser::CacheCurrentListing()
+{
+    const bool isShared = flags_ & ImGuiFileBrowserFlags_SharedListingCache;
+    if((listingCacheMaxEntries_ == 0 && !isShared) || asyncEnumeration_ || currentDirectory_.empty() ||
+       fileRecordsWriteTime_ == std::filesystem::file_time_type::min())
+    {
+        return;
+    }
+
+    StoreListing({ currentDirectory_, fileRecordsWriteTime_, std::move(fileRecords_) });
+    fileRecords_.Clear();
+    selectedRecords_.Resize(0);
+    ResetRecordCaches();
+    visibleRecordIndicesDirty_ = true;
+
+    TrimListingCache();
+}
+
+inline bool ImGui::FileBrowser::LoadCachedListing()
+{
+    // changes made after the write time is checked below are reported by the watcher
+    WatchCurrentDirectory();
+
+    if(flags_ & ImGuiFileBrowserFlags_SharedListingCache)
+    {
+        const auto lastWriteTime = GetLastWriteTime(currentDirectory_);
+        FileRecordTable records(fileRecords_.IsNaturalOrder());
+        if(!SharedListingCache::GetInstance().Get(currentDirectory_, lastWriteTime, records))
+        {
+            return false;
+        }
+
+        CancelEnumeration();
+        fileRecords_ = std::move(records);
+        fileRecordsWriteTime_ = lastWriteTime;
+    }
+    else
+    {
+        const auto it = std::find_if(
+            listingCache_.begin(), listingCache_.end(), [&](const CachedListing &listing)
+            {
+                return listing.directory == currentDirectory_;
+            });
+        if(it == listingCache_.end())
+        {
+            return false;
+        }
+
+        if(GetLastWriteTime(currentDirectory_) != it->lastWriteTime)
+        {
+            listingCache_.erase(it);
+            return false;
+        }
+
+        CancelEnumeration();
+        fileRecords_ = std::move(it->records);
+        fileRecordsWriteTime_ = it->lastWriteTime;
+        listingCache_.erase(it);
+    }
+    ResetRecordCaches();
+    selectedRecords_.Reset();
+    selectedRecords_.Resize(fileRecords_.Size());
+
+    visibleRecordIndicesDirty_ = true;
+    ClearRangeSelectionState();
+    return true;
+}
+
+inline void ImGui::FileBrowser::StoreListing(CachedListing listing)
+{
+    if(flags_ & ImGuiFileBrowserFlags_SharedListingCache)
+    {
+        SharedListingCache::GetInstance().Put(std::move(listing));
+        return;
+    }
+
+    listingCache_.remove_if([&](const CachedListing &cached) { return cached.directory == listing.directory; });
+    listingCache_.push_front(std::move(listing));
+}
+
+inline void ImGui::FileBrowser::ShareCurrentListing()
+{
+    // records of a recursive search are not a listing of current directory and have no write time
+    if((flags_ & ImGuiFileBrowserFlags_SharedListingCache) &&
+       fileRecordsWriteTime_ != std::filesystem::file_time_type::min())
+    {
+        // the copy shares the records until either side modifies them
+        SharedListingCache::GetInstance().Put({ currentDirectory_, fileRecordsWriteTime_, fileRecords_ });
+    }
+}
+
+inline ImGui::FileBrowser::SharedListingCache &ImGui::FileBrowser::SharedListingCache::GetInstance()
+{
+    static SharedListingCache instance;
+    return instance;
+}
+
+inline void ImGui::FileBrowser::SharedListingCache::SetCapacity(size_t maxEntries, size_t maxBytes)
+{
+    std::list<CachedListing> evicted;
+    std::lock_guard lock(mutex_);
+    maxEntries_ = maxEntries;
+    maxBytes_ = maxBytes;
+    Trim(evicted);
+}
+
+inline void ImGui::FileBrowser::SharedListingCache::Put(CachedListing listing)
+{
+    // released records are freed after the mutex is unlocked
+    std::list<CachedListing> evicted;
+    std::lock_guard lock(mutex_);
+
+    const bool naturalOrder = listing.records.IsNaturalOrder();
+    for(auto it = listings_.begin(); it != listings_.end(); ++it)
+    {
+        if(it->directory == listing.directory && it->records.IsNaturalOrder() == naturalOrder)
+        {
+            evicted.splice(evicted.end(), listings_, it);
+            break;
+        }
+    }
+    listings_.push_front(std::move(listing));
+    Trim(evicted);
+}
+
+inline bool ImGui::FileBrowser::SharedListingCache::Get(
+    const std::filesystem::path &dir, std::filesystem::file_time_type lastWriteTime, FileRecordTable &records)
+{
+    std::list<CachedListing> evicted;
+    std::lock_guard lock(mutex_);
+
+    const bool naturalOrder = records.IsNaturalOrder();
+    const auto it = std::find_if(listings_.begin(), listings_.end(), [&](const CachedListing &listing)
+    {
+        return listing.directory == dir && listing.records.IsNaturalOrder() == naturalOrder;
+    });
+    if(it == listings_.end())
+    {
+        return false;
+    }
+
+    if(it->lastWriteTime != lastWriteTime)
+    {
+        evicted.splice(evicted.end(), listings_, it);
+        return false;
+    }
+
+    listings_.splice(listings_.begin(), listings_, it);
+    records = it->records;
+    return true;
+}
+
+inline bool ImGui::FileBrowser::SharedListingCache::Contains(const std::filesystem::path &dir, bool naturalOrder)
+{
+    std::lock_guard lock(mutex_);
+    return std::any_of(listings_.begin(), listings_.end(), [&](const CachedListing &listing)
+    {
+        return listing.directory == dir && listing.records.IsNaturalOrder() == naturalOrder;
+    });
+}
+
+inline void ImGui::FileBrowser::SharedListingCache::Trim(std::list<CachedListing> &evicted)
+{
+    size_t totalBytes = 0;
+    for(auto &listing : listings_)
+    {
+        totalBytes += listing.records.GetMemoryUsage();
+    }
+
+    while(!listings_.empty() && (listings_.size() > maxEntries_ || totalBytes > maxBytes_))
+    {
+        totalBytes -= listings_.back().records.GetMemoryUsage();
+        evicted.splice(evicted.end(), listings_, std::prev(listings_.end()));
+    }
+}
+
+inline void ImGui::FileBrowser::TrimListingCache()
+{
+    size_t totalBytes = 0;
+    for(auto &listing : listingCache_)
+    {
+        totalBytes += listing.records.GetMemoryUsage();
+    }
+
+    while(!listingCache_.empty() &&
+          (listingCache_.size() > listingCacheMaxEntries_ || totalBytes > listingCacheMaxBytes_))
+    {
+        totalBytes -= listingCache_.back().records.GetMemoryUsage();
+        listingCache_.pop_back();
+    }
+}
+
+inline void ImGui::FileBrowser::NavigateHistory(
+    std::vector<std::filesystem::path> &from, std::vector<std::filesystem::path> &to)
+{
+    if(from.empty())
+    {
+        return;
+    }
+
+    const std::filesystem::path dst = std::move(from.back());
+    from.pop_back();
+
+    const std::filesystem::path prev = currentDirectory_;
+    SetCurrentDirectoryInternal(dst, prev);
+    if(currentDirectory_ != prev)
+    {
+        to.push_back(prev);
+    }
+}
+
+inline void ImGui::FileBrowser::SetCurrentDirectoryUncatched(const std::filesystem::path &pwd)
+{
+    // the search query is cleared below, so there is nothing left to search for
+    isRecursiveSearchActive_ = false;
+    hasPendingRecursiveSearch_ = false;
+    CacheCurrentListing();
+
+    currentDirectory_ = absolute(pwd);
+    if(!LoadCachedListing())
+    {
+        UpdateFileRecords(true);
+    }
+
+    bool shouldClearInputNameBuffer = true;
+
+    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) &&
+       !selectedInputName_.empty() &&
+       !customizedInputName_.empty() &&
+       !inputNameBuffer_.empty() &&
+       std::strcmp(inputNameBuffer_.data(), customizedInputName_.data()) == 0)
+    {
+        shouldClearInputNameBuffer = false;
+    }
+
+    selectedRecords_.Reset();
+    AssignToArrayStyleString(searchBuffer_, "");
+    SetSearchQuery({});
+    if(shouldClearInputNameBuffer)
+    {
+        selectedInputName_.clear();
+        AssignToArrayStyleString(inputNameBuffer_, "");
+    }
+}
+
+inline bool ImGui::FileBrowser::SetCurrentDirectoryInternal(
+    const std::filesystem::path &dir, const std::filesystem::path &preferredFallback)
+{
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::SetCurrentDirectory");
+    try
+    {
+        SetCurrentDirectoryUncatched(dir);
+        return true;
+    }
+    catch(const std::exception &err)
+    {
+        statusStr_ = std::string("error: ") + err.what();
+    }
+    catch(...)
+    {
+        statusStr_ = "unknown error";
+    }
+
+    {
+        IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::SetCurrentDirectoryFallback");
+        if(preferredFallback != defaultDirectory_)
+        {
+            try
+            {
+                SetCurrentDirectoryUncatched(preferredFallback);
+            }
+            catch(...)
+            {
+                SetCurrentDirectoryUncatched(defaultDirectory_);
+            }
+        }
+        else
+        {
+            SetCurrentDirectoryUncatched(defaultDirectory_);
+        }
+    }
+
+    return false;
+}
+
+inline const ImGui::FileBrowser::RecordBitset *ImGui::FileBrowser::GetTypeFilterMatches()
+{
+    // no type filters or invalid type filter index
+    if(static_cast<size_t>(typeFilterIndex_) >= typeFilters_.size())
+    {
+        return nullptr;
+    }
+
+    // universal filter
+    if(typeFilters_[typeFilterIndex_] == std::string_view(".*"))
+    {
+        return nullptr;
+    }
+
+    // records are only appended while being streamed in, so only the new ones need to be matched
+    auto &matches = typeFilterMatches_[typeFilterIndex_];
+    const auto &matcher = typeFilterMatchers_[typeFilterIndex_];
+    const size_t matchedCount = matches.Size();
+    if(matchedCount < fileRecords_.Size())
+    {
+        std::string scratch;
+        matches.Resize(fileRecords_.Size());
+        for(size_t i = matchedCount; i < fileRecords_.Size(); ++i)
+        {
+            if(!fileRecords_.IsDir(i) && matcher.IsMatched(fileRecords_.GetFileName(i), fileRecords_.GetExtension(i), scratch))
+            {
+                matches.Set(i);
+            }
+        }
+    }
+    return &matches;
+}
+
+inline void ImGui::FileBrowser::ResetRecordCaches()
+{
+    for(auto &matches : typeFilterMatches_)
+    {
+        matches.Resize(0);
+    }
+    searchMatches_.Resize(0);
+    extensionRanks_.clear();
+    ResetRecordMetadata();
+}
+
+inline void ImGui::FileBrowser::ResetRecordMetadata()
+{
+    ++metadataGeneration_;
+    recordMetadata_.clear();
+    CancelDirectorySizes();
+    backgroundMetadataRequestCount_ = 0;
+    if(metadataFetcher_)
+    {
+        std::lock_guard lock(metadataFetcher_->mutex);
+        metadataFetcher_->requests.clear();
+        metadataFetcher_->backgroundRequests.clear();
+    }
+}
+
+inline void ImGui::FileBrowser::RequestRecordMetadata(const std::vector<uint32_t> &recordIndices)
+{
+    if(!metadataFetcher_)
+    {
+        if(recordIndices.empty())
+        {
+            return;
+        }
+        metadataFetcher_ = std::make_unique<MetadataFetcher>();
+    }
+
+    std::lock_guard lock(metadataFetcher_->mutex);
+
+    // requests not taken by any worker yet are usually for rows which have been scrolled away.
+    // they will be requested again once they become visible
+    for(auto &request : metadataFetcher_->requests)
+    {
+        if(request.generation == metadataGeneration_ && request.recordIndex < recordMetadata_.size())
+        {
+            recordMetadata_[request.recordIndex].state = RecordMetadata::State_Unknown;
+        }
+    }
+    metadataFetcher_->requests.clear();
+
+    for(const uint32_t recordIndex : recordIndices)
+    {
+        metadataFetcher_->requests.push_back(
+            { metadataGeneration_, recordIndex, currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(recordIndex)) });
+        recordMetadata_[recordIndex].state = RecordMetadata::State_Pending;
+    }
+
+    if(!recordIndices.empty())
+    {
+        metadataFetcher_->condition.notify_all();
+    }
+}
+
+inline void ImGui::FileBrowser::RequestAllRecordMetadata()
+{
+    if(recordMetadata_.size() < fileRecords_.Size())
+    {
+        recordMetadata_.resize(fileRecords_.Size());
+    }
+    if(backgroundMetadataRequestCount_ >= fileRecords_.Size())
+    {
+        return;
+    }
+    if(!metadataFetcher_)
+    {
+        metadataFetcher_ = std::make_unique<MetadataFetcher>();
+    }
+
+    std::lock_guard lock(metadataFetcher_->mutex);
+    for(size_t i = (std::max)(backgroundMetadataRequestCount_, size_t(1)); i < fileRecords_.Size(); ++i)
+    {
+        if(recordMetadata_[i].state == RecordMetadata::State_Unknown)
+        {
+            metadataFetcher_->backgroundRequests.push_back(
+                { metadataGeneration_, static_cast<uint32_t>(i), currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(i)) });
+            recordMetadata_[i].state = RecordMetadata::State_Pending;
+        }
+    }
+    backgroundMetadataRequestCount_ = fileRecords_.Size();
+    metadataFetcher_->condition.notify_all();
+}
+
+inline void ImGui::FileBrowser::PollRecordMetadata()
+{
+    if(!metadataFetcher_)
+    {
+        return;
+    }
+
+    std::lock_guard lock(metadataFetcher_->mutex);
+    if(metadataFetcher_->results.empty())
+    {
+        return;
+    }
+
+    for(auto &result : metadataFetcher_->results)
+    {
+        if(result.generation == metadataGeneration_ && result.recordIndex < recordMetadata_.size())
+        {
+            recordMetadata_[result.recordIndex] = result.metadata;
+        }
+    }
+    metadataFetcher_->results.clear();
+
+    // the view is ordered by metadata. re-sorting on every result would be too slow for large directories,
+    // so do it at most twice a second until all requested metadata has arrived
+    if(sortColumn_ == SortColumn_Size || sortColumn_ == SortColumn_Modified)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const bool isDone = metadataFetcher_->requests.empty() && metadataFetcher_->backgroundRequests.empty();
+        if(isDone || now - lastMetadataSortTime_ >= std::chrono::milliseconds(500))
+        {
+            lastMetadataSortTime_ = now;
+            visibleRecordIndicesDirty_ = true;
+        }
+    }
+}
+
+inline void ImGui::FileBrowser::UpdateExtensionRanks()
+{
+    if(extensionRanks_.size() == fileRecords_.Size())
+    {
+        return;
+    }
+
+    std::vector<std::string> keys(fileRecords_.Size());
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+        FileRecordTable::AppendCollationKey(keys[i], fileRecords_.GetExtension(i), fileRecords_.IsNaturalOrder());
+    }
+
+    std::vector<uint32_t> order(fileRecords_.Size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+    {
+        if(const int cmp = keys[lhs].compare(keys[rhs]); cmp != 0)
+        {
+            return cmp < 0;
+        }
+        return lhs < rhs;
+    });
+
+    // records with extensions differing only in case share a rank
+    extensionRanks_.resize(fileRecords_.Size());
+    uint32_t rank = 0;
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        if(i > 0 && keys[order[i]] != keys[order[i - 1]])
+        {
+            ++rank;
+        }
+        extensionRanks_[order[i]] = rank;
+    }
+}
+
+inline void ImGui::FileBrowser::UpdateDirectorySizeKeys()
+{
+    directorySizeKeys_.clear();
+    if(!directorySizeJob_)
+    {
+        return;
+    }
+
+    // partial sizes are used as they are. the view is sorted again when they are complete
+    directorySizeKeys_.resize(directorySizeJob_->roots.size() + 1, UNKNOWN_DIRECTORY_SIZE);
+    for(uint32_t i = 1; i < directorySizeKeys_.size(); ++i)
+    {
+        uint64_t size;
+        bool isPartial;
+        if(GetDirectorySize(i, size, isPartial))
+        {
+            directorySizeKeys_[i] = size;
+        }
+    }
+}
+
+inline bool ImGui::FileBrowser::CompareRecordsForView(uint32_t lhs, uint32_t rhs) const
+{
+    // directories first. records are sorted by name, so indices are name keys and break ties
+    const bool lIsDir = fileRecords_.IsDir(lhs), rIsDir = fileRecords_.IsDir(rhs);
+    if(lIsDir != rIsDir)
+    {
+        return lIsDir;
+    }
+
+    auto compareKeys = [&](auto lKey, auto rKey) -> int
+    {
+        return lKey < rKey ? -1 : (rKey < lKey ? 1 : 0);
+    };
+
+    int order = 0;
+    switch(sortColumn_)
+    {
+    case SortColumn_Extension:
+        order = compareKeys(extensionRanks_[lhs], extensionRanks_[rhs]);
+        break;
+    case SortColumn_Size:
+    case SortColumn_Modified:
+    {
+        // directories are ordered by their total sizes when they are calculated. those without a size are placed
+        // last in both directions, like records without metadata below
+        if(lIsDir && sortColumn_ == SortColumn_Size && directorySizeJob_)
+        {
+            const uint64_t lSize = lhs < directorySizeKeys_.size() ? directorySizeKeys_[lhs] : UNKNOWN_DIRECTORY_SIZE;
+            const uint64_t rSize = rhs < directorySizeKeys_.size() ? directorySizeKeys_[rhs] : UNKNOWN_DIRECTORY_SIZE;
+            const bool lHasSize = lSize != UNKNOWN_DIRECTORY_SIZE, rHasSize = rSize != UNKNOWN_DIRECTORY_SIZE;
+            if(lHasSize != rHasSize)
+            {
+                return lHasSize;
+            }
+            order = compareKeys(lSize, rSize);
+            break;
+        }
+
+        // records without metadata are placed last in both directions
+        const RecordMetadata &l = recordMetadata_[lhs], &r = recordMetadata_[rhs];
+        const bool lIsReady = l.state == RecordMetadata::State_Ready, rIsReady = r.state == RecordMetadata::State_Ready;
+        if(lIsReady != rIsReady)
+        {
+            return lIsReady;
+        }
+        if(lIsReady)
+        {
+            order = sortColumn_ == SortColumn_Size ?
+                    compareKeys(l.size, r.size) : compareKeys(l.modifiedTime, r.modifiedTime);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    if(order == 0)
+    {
+        order = compareKeys(lhs, rhs);
+        if(sortColumn_ != SortColumn_Name)
+        {
+            return order < 0;
+        }
+    }
+    return sortDescending_ ? order > 0 : order < 0;
+}
+
+inline void ImGui::FileBrowser::DrawRecordDetails(uint32_t recordIndex)
+{
+    const RecordMetadata &metadata = recordMetadata_[recordIndex];
+    const bool isDir = fileRecords_.IsDir(recordIndex);
+    const bool isReady = metadata.state == RecordMetadata::State_Ready;
+
+    char text[64];
+
+    // size. partial sizes of directories are shown while they are being calculated
+    if(TableSetColumnIndex(1))
+    {
+        uint64_t size = metadata.size;
+        bool isPartial = false;
+        if(isDir ? GetDirectorySize(recordIndex, size, isPartial) : isReady)
+        {
+            FormatSize(size, text, sizeof(text));
+            if(isPartial)
+            {
+                TextDisabled("%s...", text);
+            }
+            else
+            {
+                TextUnformatted(text);
+            }
+        }
+    }
+
+    // modification time
+    if(TableSetColumnIndex(2) && isReady)
+    {
+        std::tm localTime = {};
+#ifdef _WIN32
+        const bool converted = localtime_s(&localTime, &metadata.modifiedTime) == 0;
+#else
+        const bool converted = localtime_r(&metadata.modifiedTime, &localTime) != nullptr;
+#endif
+        if(converted && std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M", &localTime))
+        {
+            TextUnformatted(text);
+        }
+    }
+
+    // type
+    if(TableSetColumnIndex(3))
+    {
+        const std::string_view extension = fileRecords_.GetExtension(recordIndex);
+        if(isDir)
+        {
+            TextUnformatted("Directory");
+        }
+        else if(extension.size() > 1)
+        {
+            TextUnformatted(extension.data() + 1, extension.data() + extension.size());
+        }
+        else
+        {
+            TextUnformatted("File");
+        }
+    }
+
+    // permissions
+    if(TableSetColumnIndex(4) && isReady && metadata.permissions != std::filesystem::perms::unknown)
+    {
+        using std::filesystem::perms;
+        const perms bits[] = {
+            perms::owner_read, perms::owner_write, perms::owner_exec,
+            perms::group_read, perms::group_write, perms::group_exec,
+            perms::others_read, perms::others_write, perms::others_exec
+        };
+        for(int i = 0; i < 9; ++i)
+        {
+            text[i] = (metadata.permissions & bits[i]) != perms::none ? "rwx"[i % 3] : '-';
+        }
+        text[9] = '\0';
+        TextUnformatted(text);
+    }
+}
+
+inline void ImGui::FileBrowser::UpdateDirectorySizes()
+{
+    // the view is ordered by partial sizes. re-sort it like PollRecordMetadata until all sizes are complete
+    if(directorySizeJob_ && sortColumn_ == SortColumn_Size && !areDirectorySizesSorted_)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const bool isDone = directorySizeJob_->pendingRootCount == 0;
+        if(isDone || now - lastMetadataSortTime_ >= std::chrono::milliseconds(500))
+        {
+            lastMetadataSortTime_ = now;
+            visibleRecordIndicesDirty_ = true;
+            areDirectorySizesSorted_ = isDone;
+        }
+    }
+
+    // indices of streamed records are not final
+    if(directorySizeJob_ || asyncEnumeration_ || hasPendingEnumeration_)
+    {
+        return;
+    }
+
+    size_t rootCount = 0;
+    while(rootCount + 1 < fileRecords_.Size() && fileRecords_.IsDir(rootCount + 1))
+    {
+        ++rootCount;
+    }
+
+    directorySizeJob_ = std::make_shared<DirectorySizeJob>(rootCount);
+    areDirectorySizesSorted_ = false;
+    for(size_t i = 0; i < rootCount; ++i)
+    {
+        directorySizeJob_->roots[i].path = currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(i + 1));
+    }
+    if(rootCount == 0)
+    {
+        return;
+    }
+
+    if(!directorySizeCalculator_)
+    {
+        directorySizeCalculator_ = std::make_unique<DirectorySizeCalculator>();
+    }
+
+    // the first root ends up at the back, where the workers take tasks from
+    std::lock_guard lock(directorySizeCalculator_->mutex);
+    for(size_t i = rootCount; i-- > 0;)
+    {
+        directorySizeCalculator_->tasks.push_back({ directorySizeJob_, i, std::filesystem::path() });
+    }
+    directorySizeCalculator_->condition.notify_all();
+}
+
+inline void ImGui::FileBrowser::CancelDirectorySizes()
+{
+    if(!directorySizeJob_)
     {
-        if(isPosSet_)
+        return;
+    }
+
+    directorySizeJob_->cancelled = true;
+    if(directorySizeCalculator_)
+    {
+        std::lock_guard lock(directorySizeCalculator_->mutex);
+        auto &tasks = directorySizeCalculator_->tasks;
+        tasks.erase(
+            std::remove_if(tasks.begin(), tasks.end(), [&](const DirectorySizeCalculator::Task &task)
+            {
+                return task.job == directorySizeJob_;
+            }),
+            tasks.end());
+    }
+    directorySizeJob_.reset();
+}
+
+inline void ImGui::FileBrowser::RecalculateDirectorySizes()
+{
+    if(directorySizeCalculator_)
+    {
+        std::lock_guard lock(directorySizeCalculator_->mutex);
+        directorySizeCalculator_->cache.clear();
+        directorySizeCalculator_->cacheOrder.clear();
+    }
+
+    // restarted by UpdateDirectorySizes
+    CancelDirectorySizes();
+}
+
+inline bool ImGui::FileBrowser::GetDirectorySize(uint32_t recordIndex, uint64_t &size, bool &isPartial) const noexcept
+{
+    if(!directorySizeJob_ || recordIndex == 0 || recordIndex > directorySizeJob_->roots.size())
+    {
+        return false;
+    }
+
+    const auto &root = directorySizeJob_->roots[recordIndex - 1];
+    isPartial = !root.isDone;
+    size = root.size;
+    return true;
+}
+
+inline void ImGui::FileBrowser::DrawPreview(size_t recordIndex, float reserveHeight)
+{
+    BeginChild("preview", ImVec2(0, -reserveHeight), true, ImGuiWindowFlags_HorizontalScrollbar);
+    ScopeGuard endChild([] { EndChild(); });
+
+    if(recordIndex >= fileRecords_.Size())
+    {
+        TextDisabled("no file selected");
+        return;
+    }
+
+    // only the latest request is kept by the loader, so changing the focus quickly never queues up reads
+    const std::filesystem::path path = currentDirectory_ / u8StrToPath(fileRecords_.GetNameCStr(recordIndex));
+    if(!previewLoader_)
+    {
+        previewLoader_ = std::make_unique<PreviewLoader>(previewMaxEntries_, previewMaxBytesPerFile_);
+    }
+    {
+        std::lock_guard lock(previewLoader_->mutex);
+        if(path != previewRequest_)
         {
-            SetNextWindowPos(ImVec2(static_cast<float>(posX_), static_cast<float>(posY_)));
+            previewLoader_->request = path;
+            previewRequest_ = path;
+            previewLoader_->condition.notify_one();
+        }
+        if(previewLoader_->result)
+        {
+            if(previewLoader_->result->path == previewRequest_)
+            {
+                preview_ = std::move(*previewLoader_->result);
+            }
+            previewLoader_->result.reset();
         }
-        SetNextWindowSize(ImVec2(static_cast<float>(width_), static_cast<float>(height_)));
     }
-    else
+
+    TextUnformatted(fileRecords_.GetNameCStr(recordIndex));
+    if(preview_.path != previewRequest_)
     {
-        if(isPosSet_)
+        TextDisabled("loading...");
+        return;
+    }
+    if(!preview_.error.empty())
+    {
+        TextDisabled("%s", preview_.error.c_str());
+        return;
+    }
+
+    char text[64];
+    FormatSize(preview_.size, text, sizeof(text));
+    TextDisabled("%s%s", text, preview_.isText ? "" : ", binary");
+    Separator();
+    TextUnformatted(preview_.contents.data(), preview_.contents.data() + preview_.contents.size());
+    if(preview_.size > previewLoader_->maxBytesPerFile)
+    {
+        TextDisabled("...");
+    }
+}
+
+inline bool ImGui::FileBrowser::IsSearchMatched(std::string_view name, std::string_view query) noexcept
+{
+    size_t termBegin = query.find_first_not_of(' ');
+    while(termBegin != std::string_view::npos)
+    {
+        const size_t termEnd = (std::min)(query.find(' ', termBegin), query.size());
+        if(!ContainsIgnoringCase(name, query.substr(termBegin, termEnd - termBegin)))
         {
-            SetNextWindowPos(ImVec2(static_cast<float>(posX_), static_cast<float>(posY_)), ImGuiCond_FirstUseEver);
+            return false;
         }
-        SetNextWindowSize(ImVec2(static_cast<float>(width_), static_cast<float>(height_)), ImGuiCond_FirstUseEver);
+        termBegin = query.find_first_not_of(' ', termEnd);
     }
-    if(flags_ & ImGuiFileBrowserFlags_NoModal)
+    return true;
+}
+
+inline bool ImGui::FileBrowser::ContainsIgnoringCase(std::string_view haystack, std::string_view needle) noexcept
+{
+    auto fold = [](char c)
+    {
+        return 'A' <= c && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    };
+    auto equalsAt = [&](size_t pos, size_t begin, size_t end)
     {
-        if(!BeginPopup(openLabel_.c_str()))
+        for(size_t j = begin; j < end; ++j)
         {
-            return;
+            if(fold(haystack[pos + j]) != needle[j])
+            {
+                return false;
+            }
         }
-    }
-    else if(!BeginPopupModal(openLabel_.c_str(), nullptr,
-                             flags_ & ImGuiFileBrowserFlags_NoTitleBar ? ImGuiWindowFlags_NoTitleBar : 0))
+        return true;
+    };
+
+    const size_t n = haystack.size(), m = needle.size();
+    if(m > n)
     {
-        return;
+        return false;
     }
 
-    isOpened_ = true;
-    ScopeGuard endPopup([] { EndPopup(); });
+    size_t i = 0;
 
-    std::filesystem::path newDir; bool shouldSetNewDir = false;
+#ifdef IMGUI_FILEBROWSER_USE_SSE2
 
-    if(editDir_)
+    // compare 16 candidate positions at once against the first and the last character of needle.
+    // only positions where both match are verified one by one
+    const __m128i upperBegin = _mm_set1_epi8('A' - 1);
+    const __m128i upperEnd   = _mm_set1_epi8('Z' + 1);
+    const __m128i caseBit    = _mm_set1_epi8(0x20);
+    auto foldBlock = [&](const char *p)
     {
-        if(setFocusToEditDir_) // Automatically set the text box to be focused on appearing
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(block, upperBegin), _mm_cmplt_epi8(block, upperEnd));
+        return _mm_add_epi8(block, _mm_and_si128(isUpper, caseBit));
+    };
+
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last  = _mm_set1_epi8(needle[m - 1]);
+    for(; i + m - 1 + 16 <= n; i += 16)
+    {
+        const __m128i firstEq = _mm_cmpeq_epi8(foldBlock(haystack.data() + i), first);
+        const __m128i lastEq = _mm_cmpeq_epi8(foldBlock(haystack.data() + i + m - 1), last);
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(firstEq, lastEq)));
+        for(size_t bit = 0; mask; ++bit, mask >>= 1)
         {
-            SetKeyboardFocusHere();
+            if((mask & 1) && equalsAt(i + bit, 1, m - 1))
+            {
+                return true;
+            }
         }
+    }
 
-        PushItemWidth(-1);
-        const bool enter = InputText(
-            "##directory", currDirBuffer_.data(), currDirBuffer_.size(),
-            ImGuiInputTextFlags_CallbackResize | ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll,
-            ExpandInputBuffer, &currDirBuffer_);
-        PopItemWidth();
+#endif
 
-        if(!IsItemActive() && !setFocusToEditDir_)
+    for(; i + m <= n; ++i)
+    {
+        if(equalsAt(i, 0, m))
         {
-            editDir_ = false;
+            return true;
         }
-        setFocusToEditDir_ = false;
+    }
+    return false;
+}
 
-        if(enter)
+inline void ImGui::FileBrowser::SetSearchQuery(std::string_view query)
+{
+    std::string newQuery(query);
+    for(char &c : newQuery)
+    {
+        c = 'A' <= c && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    if(newQuery == searchQuery_)
+    {
+        return;
+    }
+
+    // a query extending the previous one only matches a subset of its matches. re-check just those
+    if(!searchQuery_.empty() && newQuery.compare(0, searchQuery_.size(), searchQuery_) == 0)
+    {
+        for(size_t i = searchMatches_.FindNext(1); i != RecordBitset::npos; i = searchMatches_.FindNext(i + 1))
         {
-            std::filesystem::path enteredDir = u8StrToPath(currDirBuffer_.data());
-            if(is_directory(enteredDir))
-            {
-                newDir = std::move(enteredDir);
-                shouldSetNewDir = true;
-            }
-            else if(is_directory(enteredDir.parent_path()))
-            {
-                newDir = enteredDir.parent_path();
-                shouldSetNewDir = true;
-            }
-            else
+            if(!IsSearchMatched(fileRecords_.GetFileName(i), newQuery))
             {
-                statusStr_ = "[" + std::string(currDirBuffer_.data()) + "] is not a valid directory";
+                searchMatches_.Set(i, false);
             }
         }
     }
     else
     {
-        // display elements in pwd
+        searchMatches_.Resize(0);
+    }
 
-#ifdef _WIN32
-        const char currentDrive = static_cast<char>(currentDirectory_.c_str()[0]);
-        const char driveStr[] = { currentDrive, ':', '\0' };
+    searchQuery_ = std::move(newQuery);
+    visibleRecordIndicesDirty_ = true;
+}
 
-        PushItemWidth(4 * GetFontSize());
-        if(BeginCombo("##select_drive", driveStr))
+inline const ImGui::FileBrowser::RecordBitset *ImGui::FileBrowser::GetSearchMatches()
+{
+    if(searchQuery_.find_first_not_of(' ') == std::string::npos)
+    {
+        return nullptr;
+    }
+
+    // '..' is always shown
+    const size_t matchedCount = searchMatches_.Size();
+    if(matchedCount < fileRecords_.Size())
+    {
+        searchMatches_.Resize(fileRecords_.Size());
+        for(size_t i = matchedCount; i < fileRecords_.Size(); ++i)
         {
-            ScopeGuard guard([&] { EndCombo(); });
+            searchMatches_.Set(i, i == 0 || IsSearchMatched(fileRecords_.GetFileName(i), searchQuery_));
+        }
+    }
+    return &searchMatches_;
+}
 
-            for(int i = 0; i < 26; ++i)
-            {
-                if(!(drives_ & (1 << i)))
-                {
-                    continue;
-                }
+inline void ImGui::FileBrowser::UpdateVisibleRecordIndices()
+{
+    if(!visibleRecordIndicesDirty_)
+    {
+        return;
+    }
+    visibleRecordIndicesDirty_ = false;
 
-                const char driveCh = static_cast<char>('A' + i);
-                const char selectableStr[] = { driveCh, ':', '\0' };
-                const bool selected = currentDrive == driveCh;
+    IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::UpdateVisibleRecordIndices");
+    const auto startTime = std::chrono::steady_clock::now();
 
-                if(Selectable(selectableStr, selected) && !selected)
-                {
-                    char newPwd[] = { driveCh, ':', '\\', '\0' };
-                    SetDirectory(newPwd);
-                }
-            }
+    visibleRecordIndices_.clear();
+    selectableRecords_.Reset();
+    AppendVisibleRecordIndices(0);
+
+    if(!IsViewSortedByName())
+    {
+        IMGUI_FILEBROWSER_TRACE_SCOPE("FileBrowser::SortVisibleRecords");
+        if(sortColumn_ == SortColumn_Extension)
+        {
+            UpdateExtensionRanks();
+        }
+        if(sortColumn_ == SortColumn_Size)
+        {
+            UpdateDirectorySizeKeys();
+        }
+        if(recordMetadata_.size() < fileRecords_.Size())
+        {
+            recordMetadata_.resize(fileRecords_.Size());
         }
-        PopItemWidth();
 
-        SameLine();
-#endif
+        // '..' stays on the top
+        auto first = visibleRecordIndices_.begin();
+        if(first != visibleRecordIndices_.end() && fileRecords_.GetName(*first) == "..")
+        {
+            ++first;
+        }
+        std::sort(first, visibleRecordIndices_.end(), [&](uint32_t lhs, uint32_t rhs)
+        {
+            return CompareRecordsForView(lhs, rhs);
+        });
+    }
 
-        int secIdx = 0, newDirLastSecIdx = -1;
-        for(const auto &sec : currentDirectory_)
+    lastFilterMs_ = GetMillisecondsSince(startTime);
+}
+
+inline void ImGui::FileBrowser::AppendVisibleRecordIndices(size_t begin)
+{
+    const bool shouldHideRegularFiles =
+        (flags_ & ImGuiFileBrowserFlags_HideRegularFiles) && (flags_ & ImGuiFileBrowserFlags_SelectDirectory);
+
+    const bool wantDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
+    const RecordBitset *typeFilterMatches = GetTypeFilterMatches();
+    const RecordBitset *searchMatches = GetSearchMatches();
+
+    selectableRecords_.Resize(fileRecords_.Size());
+    selectedRecords_.Resize(fileRecords_.Size());
+    for(unsigned int rscIndex = static_cast<unsigned int>(begin); rscIndex < fileRecords_.Size(); ++rscIndex)
+    {
+        const bool isDir = fileRecords_.IsDir(rscIndex);
+        if(!isDir && shouldHideRegularFiles)
         {
-#ifdef _WIN32
-            if(secIdx == 1)
-            {
-                ++secIdx;
-                continue;
-            }
-#endif
+            continue;
+        }
+        if(!isDir && typeFilterMatches && !typeFilterMatches->Test(rscIndex))
+        {
+            continue;
+        }
+        if(searchMatches && !searchMatches->Test(rscIndex))
+        {
+            continue;
+        }
+        // names of search results are relative paths. the rule applies to their last component like in a listing
+        if(fileRecords_.GetFileName(rscIndex).substr(0, 1) == "$")
+        {
+            continue;
+        }
+        visibleRecordIndices_.push_back(rscIndex);
+        if(rscIndex > 0 && isDir == wantDir)
+        {
+            selectableRecords_.Set(rscIndex);
+        }
+    }
+}
 
-            PushID(secIdx);
-            if(secIdx > 0)
-            {
-                SameLine();
-            }
-            if(SmallButton(u8StrToStr(sec.u8string()).c_str()))
-            {
-                newDirLastSecIdx = secIdx;
-            }
-            PopID();
+inline bool ImGui::FileBrowser::IsViewSortedByName() const noexcept
+{
+    return !(flags_ & ImGuiFileBrowserFlags_ShowDetails) || (sortColumn_ == SortColumn_Name && !sortDescending_);
+}
 
-            ++secIdx;
+inline bool ImGui::FileBrowser::HasAnySelection() const noexcept
+{
+    return !selectedInputName_.empty() || selectedRecords_.Any();
+}
+
+inline void ImGui::FileBrowser::SelectSingleRecord(size_t i)
+{
+    selectedRecords_.Reset();
+    selectedRecords_.Set(i);
+    selectedInputName_.clear();
+}
+
+inline void ImGui::FileBrowser::RestoreSelectionByName(
+    const FileRecordTable &oldRecords, const RecordBitset &oldSelection)
+{
+    selectedRecords_.Reset();
+    selectedRecords_.Resize(fileRecords_.Size());
+    for(size_t i = oldSelection.FindNext(0); i != RecordBitset::npos; i = oldSelection.FindNext(i + 1))
+    {
+        const size_t index = FindFileRecord(fileRecords_, oldRecords.IsDir(i), oldRecords.GetName(i));
+        if(index < fileRecords_.Size())
+        {
+            selectedRecords_.Set(index);
         }
+    }
+}
 
-        if(newDirLastSecIdx >= 0)
+inline void ImGui::FileBrowser::ClearRangeSelectionState()
+{
+    rangeSelectionStart_ = 9999999;
+    const bool dir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
+    UpdateVisibleRecordIndices();
+    for(const uint32_t i : visibleRecordIndices_)
+    {
+        if(i > 0 && fileRecords_.IsDir(i) == dir)
         {
-            int i = 0;
-            std::filesystem::path dstDir;
-            for(const auto &sec : currentDirectory_)
-            {
-                if(i++ > newDirLastSecIdx)
-                {
-                    break;
-                }
-                dstDir /= sec;
-            }
+            rangeSelectionStart_ = i;
+            break;
+        }
+    }
+}
 
-#ifdef _WIN32
-            if(newDirLastSecIdx == 0)
-            {
-                dstDir /= "\\";
-            }
-#endif
+inline void ImGui::FileBrowser::FileRecordTable::Clear()
+{
+    // the arrays are kept for reuse unless other tables still refer to them
+    if(!storage_ || storage_.use_count() > 1)
+    {
+        storage_.reset();
+        return;
+    }
+
+    Storage &storage = GetMutableStorage();
+    storage.pool.clear();
+    storage.unusedPoolBytes = 0;
+    storage.nameOffsets.clear();
+    storage.nameLengths.clear();
+    storage.keyLengths.clear();
+    storage.extensionOffsets.clear();
+    storage.recordFlags.clear();
+}
+
+inline void ImGui::FileBrowser::FileRecordTable::Add(bool isDir, std::string_view name)
+{
+    Storage &storage = GetMutableStorage();
+
+    const size_t nameOffset = storage.pool.size();
+    storage.pool.append(name);
+    storage.pool.push_back('\0');
+    AppendCollationKey(storage.pool, name, naturalOrder_);
+
+    storage.nameOffsets.push_back(static_cast<uint32_t>(nameOffset));
+    storage.nameLengths.push_back(static_cast<uint16_t>(name.size()));
+    storage.keyLengths.push_back(static_cast<uint16_t>(storage.pool.size() - nameOffset - name.size() - 1));
+    storage.extensionOffsets.push_back(static_cast<uint16_t>(GetExtensionOffset(name)));
+    storage.recordFlags.push_back(isDir ? RecordFlag_Dir : 0);
+}
 
-            SetDirectory(dstDir);
-        }
+inline void ImGui::FileBrowser::FileRecordTable::Insert(size_t i, bool isDir, std::string_view name)
+{
+    Add(isDir, name);
 
-        if(flags_ & ImGuiFileBrowserFlags_EditPathString)
-        {
-            SameLine();
+    // rotate the new record from the back to position i
+    auto rotate = [&](auto &arr)
+    {
+        std::rotate(arr.begin() + i, arr.end() - 1, arr.end());
+    };
+    Storage &storage = *storage_;
+    rotate(storage.nameOffsets);
+    rotate(storage.nameLengths);
+    rotate(storage.keyLengths);
+    rotate(storage.extensionOffsets);
+    rotate(storage.recordFlags);
+}
 
-            if(SmallButton("#"))
-            {
-                const auto currDirStr = u8StrToStr(currentDirectory_.u8string());
-                currDirBuffer_.resize(currDirStr.size() + 1);
-                std::memcpy(currDirBuffer_.data(), currDirStr.data(), currDirStr.size());
-                currDirBuffer_.back() = '\0';
+inline void ImGui::FileBrowser::FileRecordTable::Erase(size_t i)
+{
+    Storage &storage = GetMutableStorage();
+    storage.unusedPoolBytes += storage.nameLengths[i] + 1 + storage.keyLengths[i];
 
-                editDir_ = true;
-                setFocusToEditDir_ = true;
-            }
-            else
-            {
-                ToolTip("Edit the current path");
-            }
-        }
+    storage.nameOffsets.erase(storage.nameOffsets.begin() + i);
+    storage.nameLengths.erase(storage.nameLengths.begin() + i);
+    storage.keyLengths.erase(storage.keyLengths.begin() + i);
+    storage.extensionOffsets.erase(storage.extensionOffsets.begin() + i);
+    storage.recordFlags.erase(storage.recordFlags.begin() + i);
+
+    if(storage.unusedPoolBytes > storage.pool.size() / 2)
+    {
+        CompactPool(storage);
     }
+}
 
-    SameLine();
-    if(SmallButton("*"))
+inline ImGui::FileBrowser::FileRecordTable::Storage &ImGui::FileBrowser::FileRecordTable::GetMutableStorage()
+{
+    if(!storage_)
     {
-#ifdef _WIN32
-        drives_ = GetDrivesBitMask();
-#endif
+        storage_ = std::make_shared<Storage>();
+    }
+    else if(storage_.use_count() > 1)
+    {
+        storage_ = std::make_shared<Storage>(*storage_);
+    }
+    else
+    {
+        // a copy released by another thread may have been reading the storage until just now
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *storage_;
+}
 
-        UpdateFileRecords();
+inline void ImGui::FileBrowser::FileRecordTable::CompactPool(Storage &storage)
+{
+    std::string newPool;
+    newPool.reserve(storage.pool.size() - storage.unusedPoolBytes);
+    for(size_t i = 0; i < storage.nameOffsets.size(); ++i)
+    {
+        const uint32_t newOffset = static_cast<uint32_t>(newPool.size());
+        newPool.append(
+            storage.pool.data() + storage.nameOffsets[i], storage.nameLengths[i] + 1 + storage.keyLengths[i]);
+        storage.nameOffsets[i] = newOffset;
+    }
+    storage.pool = std::move(newPool);
+    storage.unusedPoolBytes = 0;
+}
 
-        std::set<std::filesystem::path> newSelectedFilenames;
-        for(auto &name : selectedFilenames_)
-        {
-            const auto it = std::find_if(
-                fileRecords_.begin(), fileRecords_.end(), [&](const FileRecord &record)
-                {
-                    return name == record.name;
-                });
-            if(it != fileRecords_.end())
-            {
-                newSelectedFilenames.insert(name);
-            }
-        }
+inline void ImGui::FileBrowser::FileRecordTable::Append(const FileRecordTable &other, size_t begin, size_t end)
+{
+    if(begin == end)
+    {
+        return;
+    }
 
-        if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) && !inputNameBuffer_.empty() && inputNameBuffer_[0])
-        {
-            newSelectedFilenames.insert(u8StrToPath(inputNameBuffer_.data()));
-        }
+    // keys are copied as they are
+    assert(naturalOrder_ == other.naturalOrder_);
+    Storage &storage = GetMutableStorage();
+    const Storage &otherStorage = *other.storage_;
+    for(size_t i = begin; i < end; ++i)
+    {
+        storage.nameOffsets.push_back(static_cast<uint32_t>(storage.pool.size()));
+        storage.nameLengths.push_back(otherStorage.nameLengths[i]);
+        storage.keyLengths.push_back(otherStorage.keyLengths[i]);
+        storage.extensionOffsets.push_back(otherStorage.extensionOffsets[i]);
+        storage.recordFlags.push_back(otherStorage.recordFlags[i]);
+
+        storage.pool.append(other.GetNameCStr(i), otherStorage.nameLengths[i] + 1 + otherStorage.keyLengths[i]);
     }
-    else
+}
+
+inline void ImGui::FileBrowser::FileRecordTable::Permute(const std::vector<uint32_t> &newToOld)
+{
+    if(newToOld.empty())
     {
-        ToolTip("Refresh");
+        return;
     }
 
-    bool focusOnInputText = false;
-    if(flags_ & ImGuiFileBrowserFlags_CreateNewDir)
+    // names stay where they are in the pool. only the per-record arrays are reordered by following
+    // the cycles of the permutation, so no second copy of the table is needed
+    Storage &storage = GetMutableStorage();
+    std::vector<bool> visited(newToOld.size(), false);
+    for(size_t start = 0; start < newToOld.size(); ++start)
     {
-        SameLine();
-        if(SmallButton("+"))
-        {
-            OpenPopup(openNewDirLabel_.c_str());
-            newDirNameBuffer_[0] = '\0';
-        }
-        else
+        if(visited[start] || newToOld[start] == start)
         {
-            ToolTip("Create a new directory");
+            continue;
         }
 
-        if(BeginPopup(openNewDirLabel_.c_str()))
-        {
-            ScopeGuard endNewDirPopup([] { EndPopup(); });
-
-            InputText(
-                "name", newDirNameBuffer_.data(), newDirNameBuffer_.size(),
-                ImGuiInputTextFlags_CallbackResize, ExpandInputBuffer, &newDirNameBuffer_);
-            focusOnInputText |= IsItemFocused();
-            SameLine();
+        const uint32_t nameOffset = storage.nameOffsets[start];
+        const uint16_t nameLength = storage.nameLengths[start];
+        const uint16_t keyLength = storage.keyLengths[start];
+        const uint16_t extensionOffset = storage.extensionOffsets[start];
+        const uint8_t recordFlags = storage.recordFlags[start];
 
-            if(Button("ok") && newDirNameBuffer_[0] != '\0')
+        size_t dst = start;
+        while(true)
+        {
+            visited[dst] = true;
+            const size_t src = newToOld[dst];
+            if(src == start)
             {
-                ScopeGuard closeNewDirPopup([] { CloseCurrentPopup(); });
-                if(create_directory(currentDirectory_ / u8StrToPath(newDirNameBuffer_.data())))
-                {
-                    UpdateFileRecords();
-                }
-                else
-                {
-                    statusStr_ = "failed to create " + std::string(newDirNameBuffer_.data());
-                }
+                break;
             }
+            storage.nameOffsets[dst] = storage.nameOffsets[src];
+            storage.nameLengths[dst] = storage.nameLengths[src];
+            storage.keyLengths[dst] = storage.keyLengths[src];
+            storage.extensionOffsets[dst] = storage.extensionOffsets[src];
+            storage.recordFlags[dst] = storage.recordFlags[src];
+            dst = src;
         }
-    }
 
-    // browse files in a child window
+        storage.nameOffsets[dst] = nameOffset;
+        storage.nameLengths[dst] = nameLength;
+        storage.keyLengths[dst] = keyLength;
+        storage.extensionOffsets[dst] = extensionOffset;
+        storage.recordFlags[dst] = recordFlags;
+    }
+}
 
-    float reserveHeight = GetFrameHeightWithSpacing();
-    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+inline size_t ImGui::FileBrowser::FileRecordTable::GetMemoryUsage() const noexcept
+{
+    if(!storage_)
     {
-        reserveHeight += GetFrameHeightWithSpacing();
+        return 0;
     }
+    return storage_->pool.capacity() +
+           storage_->nameOffsets.capacity() * sizeof(uint32_t) +
+           storage_->nameLengths.capacity() * sizeof(uint16_t) +
+           storage_->keyLengths.capacity() * sizeof(uint16_t) +
+           storage_->extensionOffsets.capacity() * sizeof(uint16_t) +
+           storage_->recordFlags.capacity() * sizeof(uint8_t);
+}
 
+inline void ImGui::FileBrowser::FileRecordTable::AppendCollationKey(
+    std::string &out, std::string_view name, bool naturalOrder)
+{
+    // Keys are compared bytewise, and utf-8 preserves the order of code points, so a key is the folded name
+    // re-encoded as utf-8. With natural order, a digit sequence is encoded as '0', its length without leading
+    // zeros and then its digits, which sorts it by value while keeping it where a digit would be.
+    // Bytes that are not valid utf-8 are kept as they are
+    out.reserve(out.size() + name.size());
+    const auto *p = reinterpret_cast<const unsigned char *>(name.data());
+    const size_t n = name.size();
+    size_t i = 0;
+    while(i < n)
     {
-        BeginChild("ch", ImVec2(0, -reserveHeight), true,
-                   (flags_ & ImGuiFileBrowserFlags_NoModal) ? ImGuiWindowFlags_AlwaysHorizontalScrollbar : 0);
-        ScopeGuard endChild([] { EndChild(); });
-
-        const bool shouldHideRegularFiles =
-            (flags_ & ImGuiFileBrowserFlags_HideRegularFiles) && (flags_ & ImGuiFileBrowserFlags_SelectDirectory);
-
-        for(unsigned int rscIndex = 0; rscIndex < fileRecords_.size(); ++rscIndex)
+#ifdef IMGUI_FILEBROWSER_USE_SSE2
+        // fast path for blocks of 16 ascii bytes, which is most of all names
+        size_t blockEnd = i;
+        if(n - i >= 16)
         {
-            const auto &rsc = fileRecords_[rscIndex];
-            if(!rsc.isDir && shouldHideRegularFiles)
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            int special = _mm_movemask_epi8(block);
+            if(naturalOrder)
             {
-                continue;
-            }
-            if(!rsc.isDir && !IsExtensionMatched(rsc.extension))
-            {
-                continue;
+                const __m128i isDigit = _mm_and_si128(
+                    _mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1)));
+                special |= _mm_movemask_epi8(isDigit);
             }
-            if(!rsc.name.empty() && rsc.name.c_str()[0] == '$')
+            if(!special)
             {
+                const __m128i isUpper = _mm_and_si128(
+                    _mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+                const __m128i folded = _mm_add_epi8(block, _mm_and_si128(isUpper, _mm_set1_epi8('a' - 'A')));
+                char buffer[16];
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer), folded);
+                out.append(buffer, 16);
+                i += 16;
                 continue;
             }
-
-            const bool selected = selectedFilenames_.find(rsc.name) != selectedFilenames_.end();
-            
-#if IMGUI_VERSION_NUM >= 19100
-            const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_NoAutoClosePopups;
+            blockEnd = i + 16;
+        }
 #else
-            const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_DontClosePopups;
+        const size_t blockEnd = i;
 #endif
 
-            if(Selectable(rsc.showName.c_str(), selected, selectableFlag))
-            {
-                const bool wantDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
-                const bool canSelect = rsc.name != ".." && rsc.isDir == wantDir;
-                const bool rangeSelect =
-                    canSelect && GetIO().KeyShift &&
-                    rangeSelectionStart_ < fileRecords_.size() &&
-                    (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
-                    IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
-                const bool multiSelect =
-                    !rangeSelect && GetIO().KeyCtrl &&
-                    (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
-                    IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
-
-                if(rangeSelect)
+        // scalar path for the rest of the block, so that the next block starts at a boundary again
+        do
+        {
+            const unsigned char c = p[i];
+            if(naturalOrder && '0' <= c && c <= '9')
+            {
+                size_t end = i;
+                while(end < n && '0' <= p[end] && p[end] <= '9')
                 {
-                    const unsigned int first = (std::min)(rangeSelectionStart_, rscIndex);
-                    const unsigned int last = (std::max)(rangeSelectionStart_, rscIndex);
-                    selectedFilenames_.clear();
-                    for(unsigned int i = first; i <= last; ++i)
-                    {
-                        if(fileRecords_[i].isDir != wantDir)
-                        {
-                            continue;
-                        }
-                        if(!wantDir && !IsExtensionMatched(fileRecords_[i].extension))
-                        {
-                            continue;
-                        }
-                        selectedFilenames_.insert(fileRecords_[i].name);
-                    }
+                    ++end;
                 }
-                else if(selected)
+                size_t begin = i;
+                while(end - begin > 1 && p[begin] == '0')
                 {
-                    if(!multiSelect)
-                    {
-                        selectedFilenames_ = { rsc.name };
-                        rangeSelectionStart_ = rscIndex;
-                    }
-                    else
-                    {
-                        selectedFilenames_.erase(rsc.name);
-                    }
-                    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
-                    {
-                        AssignToArrayStyleString(inputNameBuffer_, "");
-                    }
+                    ++begin;
                 }
-                else if(canSelect)
+
+                const size_t length = end - begin;
+                out.push_back('0');
+                if(length < 255)
                 {
-                    if(multiSelect)
-                    {
-                        selectedFilenames_.insert(rsc.name);
-                    }
-                    else
-                    {
-                        selectedFilenames_ = { rsc.name };
-                    }
-                    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
-                    {
-                        const auto rscName = u8StrToStr(rsc.name.u8string());
-                        AssignToArrayStyleString(inputNameBuffer_, rscName);
-                    }
-                    rangeSelectionStart_ = rscIndex;
+                    out.push_back(static_cast<char>(length));
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(255));
+                    out.push_back(static_cast<char>((length >> 8) & 0xff));
+                    out.push_back(static_cast<char>(length & 0xff));
                 }
+                out.append(name.data() + begin, length);
+                i = end;
             }
-
-            if(IsMouseDoubleClicked(ImGuiMouseButton_Left) && IsItemHovered(ImGuiHoveredFlags_None))
+            else if(c < 0x80)
+            {
+                out.push_back(static_cast<char>(('A' <= c && c <= 'Z') ? c + ('a' - 'A') : c));
+                ++i;
+            }
+            else
             {
-                if(rsc.isDir)
+                // decode a utf-8 sequence
+                const size_t length = c >= 0xf0 ? 4 : (c >= 0xe0 ? 3 : (c >= 0xc0 ? 2 : 0));
+                bool isValid = length != 0 && c < 0xf5 && i + length <= n;
+                uint32_t cp = length == 4 ? c & 0x07 : (length == 3 ? c & 0x0f : c & 0x1f);
+                for(size_t j = 1; isValid && j < length; ++j)
                 {
-                    shouldSetNewDir = true;
-                    newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
+                    isValid = (p[i + j] & 0xc0) == 0x80;
+                    cp = (cp << 6) | (p[i + j] & 0x3f);
                 }
-                else if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+                if(!isValid)
                 {
-                    selectedFilenames_ = { rsc.name };
-                    isOk_ = true;
-                    CloseCurrentPopup();
+                    out.push_back(static_cast<char>(c));
+                    ++i;
+                    continue;
                 }
-            }
-            else if(IsKeyPressed(ImGuiKey_GamepadFaceDown) && IsItemHovered()) 
-            {
-                if(rsc.isDir)
+
+                cp = FoldCodePoint(cp);
+                if(cp < 0x80)
+                {
+                    out.push_back(static_cast<char>(cp));
+                }
+                else if(cp < 0x800)
+                {
+                    out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+                }
+                else if(cp < 0x10000)
                 {
-                    shouldSetNewDir = true;
-                    newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
-                    SetKeyboardFocusHere(-1);
+                    out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
                 }
-                else if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+                else
                 {
-                    selectedFilenames_ = { rsc.name };
-                    isOk_ = true;
-                    CloseCurrentPopup();
+                    out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+                    out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
                 }
+                i += length;
             }
-        }
+        } while(i < blockEnd);
     }
+}
 
-    if(shouldSetNewDir)
+inline uint32_t ImGui::FileBrowser::FileRecordTable::FoldCodePoint(uint32_t c) noexcept
+{
+    if(c < 0x80)
     {
-        SetDirectory(newDir);
+        return ('A' <= c && c <= 'Z') ? c + 0x20 : c;
     }
 
-    if(flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+    // latin-1 supplement and latin extended-a
+    if(0xc0 <= c && c <= 0xde && c != 0xd7)
     {
-        PushID(this);
-        ScopeGuard popTextID([] { PopID(); });
-
-        if(inputNameBuffer_.empty())
-        {
-            inputNameBuffer_.resize(1, '\0');
-        }
-
-        PushItemWidth(-1);
-        if(InputText(
-            "", inputNameBuffer_.data(), inputNameBuffer_.size(),
-            ImGuiInputTextFlags_CallbackResize, ExpandInputBuffer, &inputNameBuffer_) && inputNameBuffer_[0] != '\0')
-        {
-            selectedFilenames_ = { u8StrToPath(inputNameBuffer_.data()) };
-        }
-        focusOnInputText |= IsItemFocused();
-        PopItemWidth();
+        return c + 0x20;
     }
-
-    if(!focusOnInputText && !editDir_)
+    if(0x100 <= c && c <= 0x17f)
     {
-        const bool selectAll = (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
-                               IsKeyPressed(ImGuiKey_A) && (IsKeyDown(ImGuiKey_LeftCtrl) ||
-                               IsKeyDown(ImGuiKey_RightCtrl));
-        if(selectAll)
+        if(c == 0x178)
         {
-            const bool needDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
-            selectedFilenames_.clear();
-            for(size_t i = 1; i < fileRecords_.size(); ++i)
-            {
-                auto &record = fileRecords_[i];
-                if(record.isDir == needDir &&
-                   (needDir || IsExtensionMatched(record.extension)))
-                {
-                    selectedFilenames_.insert(record.name);
-                }
-            }
+            return 0xff;
         }
+        const bool isEvenUpper = (c <= 0x12f) || (0x132 <= c && c <= 0x137) || (0x14a <= c && c <= 0x177);
+        const bool isOddUpper = (0x139 <= c && c <= 0x148) || (0x179 <= c && c <= 0x17e);
+        return (isEvenUpper && c % 2 == 0) || (isOddUpper && c % 2 == 1) ? c + 1 : c;
     }
 
-    const bool isEnterPressed =
-        (flags_ & ImGuiFileBrowserFlags_ConfirmOnEnter) &&
-        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
-        IsKeyPressed(ImGuiKey_Enter);
-    if(!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
+    // greek
+    if(c == 0x386)
     {
-        if((Button(" ok ") || isEnterPressed) && !selectedFilenames_.empty())
-        {
-            isOk_ = true;
-            CloseCurrentPopup();
-        }
+        return 0x3ac;
     }
-    else
+    if(0x388 <= c && c <= 0x38a)
     {
-        if(Button(" ok ") || isEnterPressed)
-        {
-            isOk_ = true;
-            CloseCurrentPopup();
-        }
+        return c + 0x25;
     }
-
-    SameLine();
-
-    const bool shouldClose =
-        Button("cancel") || shouldClose_ ||
-        ((flags_ & ImGuiFileBrowserFlags_CloseOnEsc) &&
-        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
-        IsKeyPressed(ImGuiKey_Escape));
-    if(shouldClose)
+    if(c == 0x38c)
     {
-        CloseCurrentPopup();
+        return 0x3cc;
     }
-
-    if(!statusStr_.empty() && !(flags_ & ImGuiFileBrowserFlags_NoStatusBar))
+    if(c == 0x38e || c == 0x38f)
     {
-        SameLine();
-        Text("%s", statusStr_.c_str());
+        return c + 0x3f;
     }
-
-    if(!typeFilters_.empty())
+    if(0x391 <= c && c <= 0x3ab && c != 0x3a2)
     {
-        SameLine();
-        PushItemWidth(8 * GetFontSize());
-        if(BeginCombo(
-            "##type_filters", typeFilters_[typeFilterIndex_].c_str()))
-        {
-            ScopeGuard guard([&] { EndCombo(); });
-
-            for(size_t i = 0; i < typeFilters_.size(); ++i)
-            {
-                bool selected = i == typeFilterIndex_;
-                if(Selectable(typeFilters_[i].c_str(), selected) && !selected)
-                {
-                    typeFilterIndex_ = static_cast<unsigned int>(i);
-                }
-            }
-        }
-        PopItemWidth();
+        return c + 0x20;
     }
-}
-
-inline bool ImGui::FileBrowser::HasSelected() const noexcept
-{
-    return isOk_;
-}
 
-inline bool ImGui::FileBrowser::SetDirectory(const std::filesystem::path &dir)
-{
-    const std::filesystem::path preferredFallback = this->GetDirectory();
-    return SetCurrentDirectoryInternal(dir, preferredFallback);
-}
+    // cyrillic and armenian
+    if(0x400 <= c && c <= 0x40f)
+    {
+        return c + 0x50;
+    }
+    if(0x410 <= c && c <= 0x42f)
+    {
+        return c + 0x20;
+    }
+    if(((0x460 <= c && c <= 0x481) || (0x48a <= c && c <= 0x4bf)) && c % 2 == 0)
+    {
+        return c + 1;
+    }
+    if(0x531 <= c && c <= 0x556)
+    {
+        return c + 0x30;
+    }
 
-inline const std::filesystem::path &ImGui::FileBrowser::GetDirectory() const noexcept
-{
-    return currentDirectory_;
-}
+    // latin extended additional
+    if(((0x1e00 <= c && c <= 0x1e95) || (0x1ea0 <= c && c <= 0x1eff)) && c % 2 == 0)
+    {
+        return c + 1;
+    }
 
-inline std::filesystem::path ImGui::FileBrowser::GetSelected() const
-{
-    // when isOk_ is true, selectedFilenames_ may be empty if SelectDirectory
-    // is enabled. return pwd in that case.
-    if(selectedFilenames_.empty())
+    // kelvin and angstrom signs, fullwidth latin
+    if(c == 0x212a)
     {
-        return currentDirectory_;
+        return 'k';
+    }
+    if(c == 0x212b)
+    {
+        return 0xe5;
+    }
+    if(0xff21 <= c && c <= 0xff3a)
+    {
+        return c + 0x20;
     }
-    return currentDirectory_ / *selectedFilenames_.begin();
+    return c;
 }
 
-inline std::vector<std::filesystem::path> ImGui::FileBrowser::GetMultiSelected() const
+inline size_t ImGui::FileBrowser::FileRecordTable::GetExtensionOffset(std::string_view name) noexcept
 {
-    if(selectedFilenames_.empty())
+    const size_t fileNamePos = name.rfind('/') + 1;
+    const std::string_view fileName = name.substr(fileNamePos);
+    if(fileName == "." || fileName == "..")
     {
-        return { currentDirectory_ };
+        return name.size();
     }
-
-    std::vector<std::filesystem::path> ret;
-    ret.reserve(selectedFilenames_.size());
-    for(auto &s : selectedFilenames_)
+    const size_t dotPos = fileName.rfind('.');
+    if(dotPos == std::string_view::npos || dotPos == 0)
     {
-        ret.push_back(currentDirectory_ / s);
+        return name.size();
     }
-
-    return ret;
+    return fileNamePos + dotPos;
 }
 
-inline void ImGui::FileBrowser::ClearSelected()
+inline void ImGui::FileBrowser::RecordBitset::Resize(size_t size)
 {
-    selectedFilenames_.clear();
-    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename))
+    words_.resize((size + 63) / 64, 0);
+    size_ = size;
+    if(size_ % 64)
     {
-        AssignToArrayStyleString(inputNameBuffer_, "");
+        words_.back() &= (uint64_t(1) << (size_ % 64)) - 1;
     }
-    isOk_ = false;
 }
 
-inline void ImGui::FileBrowser::SetTypeFilters(const std::vector<std::string> &_typeFilters)
+inline void ImGui::FileBrowser::RecordBitset::Reset() noexcept
 {
-    typeFilters_.clear();
-
-    // remove duplicate filter names due to case unsensitivity on windows
-
-#ifdef _WIN32
+    std::fill(words_.begin(), words_.end(), 0);
+}
 
-    std::vector<std::string> typeFilters;
-    for(auto &rawFilter : _typeFilters)
+inline void ImGui::FileBrowser::RecordBitset::SetRange(size_t begin, size_t end) noexcept
+{
+    end = (std::min)(end, size_);
+    while(begin < end)
     {
-        std::string lowerFilter = ToLower(rawFilter);
-        const auto it = std::find(typeFilters.begin(), typeFilters.end(), lowerFilter);
-        if(it == typeFilters.end())
-        {
-            typeFilters.push_back(std::move(lowerFilter));
-        }
+        const size_t bit = begin % 64;
+        const size_t count = (std::min)(64 - bit, end - begin);
+        const uint64_t mask = count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << bit;
+        words_[begin / 64] |= mask;
+        begin += count;
     }
+}
 
-#else
-
-    auto &typeFilters = _typeFilters;
-
-#endif
+inline void ImGui::FileBrowser::RecordBitset::Insert(size_t i)
+{
+    Resize(size_ + 1);
 
-    // insert auto-generated filter
-    hasAllFilter_ = false;
-    if(typeFilters.size() > 1)
+    // shift whole words after the one containing i, then split that word at i
+    const size_t wordIndex = i / 64;
+    for(size_t w = words_.size() - 1; w > wordIndex; --w)
     {
-        hasAllFilter_  = true;
-        std::string allFiltersName = std::string();
-        for(size_t i = 0; i < typeFilters.size(); ++i)
-        {
-            if(typeFilters[i] == std::string_view(".*"))
-            {
-                hasAllFilter_ = false;
-                break;
-            }
-
-            if(i > 0)
-            {
-                allFiltersName += ",";
-            }
-            allFiltersName += typeFilters[i];
-        }
+        words_[w] = (words_[w] << 1) | (words_[w - 1] >> 63);
+    }
+    const uint64_t lowMask = (uint64_t(1) << (i % 64)) - 1;
+    const uint64_t word = words_[wordIndex];
+    words_[wordIndex] = (word & lowMask) | ((word & ~lowMask) << 1);
+}
 
-        if(hasAllFilter_)
-        {
-            typeFilters_.push_back(std::move(allFiltersName));
-        }
+inline void ImGui::FileBrowser::RecordBitset::Erase(size_t i)
+{
+    const size_t wordIndex = i / 64;
+    const uint64_t lowMask = (uint64_t(1) << (i % 64)) - 1;
+    const uint64_t word = words_[wordIndex];
+    words_[wordIndex] = (word & lowMask) | ((word >> 1) & ~lowMask);
+    for(size_t w = wordIndex; w + 1 < words_.size(); ++w)
+    {
+        words_[w] |= words_[w + 1] << 63;
+        words_[w + 1] >>= 1;
     }
 
-    std::copy(typeFilters.begin(), typeFilters.end(), std::back_inserter(typeFilters_));
-    typeFilterIndex_ = 0;
+    Resize(size_ - 1);
 }
 
-inline void ImGui::FileBrowser::SetCurrentTypeFilterIndex(int index)
+inline void ImGui::FileBrowser::RecordBitset::And(const RecordBitset &other) noexcept
 {
-    typeFilterIndex_ = static_cast<unsigned int>(index);
+    for(size_t w = 0; w < words_.size(); ++w)
+    {
+        words_[w] &= other.words_[w];
+    }
 }
 
-inline void ImGui::FileBrowser::SetInputName(std::string_view input)
+inline bool ImGui::FileBrowser::RecordBitset::Any() const noexcept
 {
-    assert((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) &&
-           "SetInputName can only be called when ImGuiFileBrowserFlags_EnterNewFilename is enabled");
-    customizedInputName_ = input;
+    return std::any_of(words_.begin(), words_.end(), [](uint64_t word) { return word != 0; });
 }
 
-inline std::string ImGui::FileBrowser::ToLower(const std::string &s)
+inline size_t ImGui::FileBrowser::RecordBitset::Count() const noexcept
 {
-    std::string ret = s;
-    for(char &c : ret)
+    size_t ret = 0;
+    for(uint64_t word : words_)
     {
-        c = static_cast<char>(std::tolower(c));
+        word = word - ((word >> 1) & 0x5555555555555555);
+        word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+        ret += static_cast<size_t>((word * 0x0101010101010101) >> 56);
     }
     return ret;
 }
 
-inline void ImGui::FileBrowser::ToolTip(const std::string_view &s)
+inline size_t ImGui::FileBrowser::RecordBitset::FindNext(size_t i) const noexcept
 {
-    if (!ImGui::IsItemHovered())
+    if(i >= size_)
     {
-        return;
+        return npos;
     }
-    ImGui::SetTooltip("%s", s.data());
-}
-
-inline void ImGui::FileBrowser::UpdateFileRecords()
-{
-    fileRecords_ = { FileRecord{ true, "..", "[D] ..", "" } };
 
-    for(auto &p : std::filesystem::directory_iterator(currentDirectory_))
+    size_t wordIndex = i / 64;
+    uint64_t word = words_[wordIndex] & (~uint64_t(0) << (i % 64));
+    while(!word)
     {
-        FileRecord rcd;
-        try
-        {
-            if(p.is_regular_file())
-            {
-                rcd.isDir = false;
-            }
-            else if(p.is_directory())
-            {
-                rcd.isDir = true;
-            }
-            else
-            {
-                continue;
-            }
-
-            rcd.name = p.path().filename();
-            if(rcd.name.empty())
-            {
-                continue;
-            }
-
-            rcd.extension = p.path().filename().extension();
-            rcd.showName = (rcd.isDir ? "[D] " : "[F] ") + u8StrToStr(p.path().filename().u8string());
-        }
-        catch(...)
+        if(++wordIndex >= words_.size())
         {
-            if(!(flags_ & ImGuiFileBrowserFlags_SkipItemsCausingError))
-            {
-                throw;
-            }
-            continue;
+            return npos;
         }
-        fileRecords_.push_back(rcd);
+        word = words_[wordIndex];
     }
 
-    // The default lexicographical order does not meet our sorting requirements.
-    // We want [b0, a0, A1] to be sorted into something like [a0, A1, b0] instead of [a0, b0, A1].
-    // Therefore, here we compute a custom key for each filename for sorting.
-    if(fileRecords_.size() > 2)
+    size_t bit = 0;
+    while(!(word & 1))
     {
-        std::vector<std::vector<uint32_t>> keys;
-        keys.reserve(fileRecords_.size());
-        for(auto &fileRecord : fileRecords_)
-        {
-            const auto name = u8StrToStr(fileRecord.name.u8string());
-            auto& key = keys.emplace_back();
-            key.reserve(name.size() + 1);
-            key.emplace_back(!fileRecord.isDir);
-            for(char c : name)
-            {
-                if('A' <= c && c <= 'Z')
-                {
-                    key.emplace_back(2 * (c + 'a' - 'A') + 1);
-                }
-                else
-                {
-                    key.emplace_back(2 * c);
-                }
-            }
-        }
-
-        std::vector<uint32_t> fileRecordRemapIndices;
-        fileRecordRemapIndices.reserve(fileRecords_.size());
-        for(uint32_t i = 0; i < fileRecords_.size(); ++i)
-        {
-            fileRecordRemapIndices.push_back(i);
-        }
-
-        std::sort(
-            fileRecordRemapIndices.begin() + 1, fileRecordRemapIndices.end(), [&](uint32_t li, uint32_t ri)
-            {
-                return keys[li] < keys[ri];
-            });
-
-        std::vector<FileRecord> remappedFileRecords;
-        remappedFileRecords.reserve(fileRecords_.size());
-        for(const uint32_t index : fileRecordRemapIndices)
-        {
-            remappedFileRecords.emplace_back(std::move(fileRecords_[index]));
-        }
-
-        fileRecords_ = std::move(remappedFileRecords);
+        word >>= 1;
+        ++bit;
     }
-
-    ClearRangeSelectionState();
+    return wordIndex * 64 + bit;
 }
 
-inline void ImGui::FileBrowser::SetCurrentDirectoryUncatched(const std::filesystem::path &pwd)
+inline void ImGui::FileBrowser::TypeFilterMatcher::Add(std::string_view filter)
 {
-    currentDirectory_ = absolute(pwd);
-    UpdateFileRecords();
-
-    bool shouldClearInputNameBuffer = true;
-
-    if((flags_ & ImGuiFileBrowserFlags_EnterNewFilename) &&
-       selectedFilenames_.size() == 1 &&
-       !customizedInputName_.empty() &&
-       !inputNameBuffer_.empty() &&
-       std::strcmp(inputNameBuffer_.data(), customizedInputName_.data()) == 0)
-    {
-        shouldClearInputNameBuffer = false;
-    }
-
-    if(shouldClearInputNameBuffer)
+    std::string folded(filter);
+    for(char &c : folded)
     {
-        selectedFilenames_.clear();
-        AssignToArrayStyleString(inputNameBuffer_, "");
+        c = Fold(c);
     }
-}
 
-inline bool ImGui::FileBrowser::SetCurrentDirectoryInternal(
-    const std::filesystem::path &dir, const std::filesystem::path &preferredFallback)
-{
-    try
+    if(folded == ".*")
     {
-        SetCurrentDirectoryUncatched(dir);
-        return true;
+        matchesAll_ = true;
     }
-    catch(const std::exception &err)
+    else if(folded.find_first_of("*?") != std::string::npos)
     {
-        statusStr_ = std::string("error: ") + err.what();
+        globs_.push_back(std::move(folded));
     }
-    catch(...)
+    else if(folded.empty() || (folded[0] == '.' && folded.find('.', 1) == std::string::npos))
     {
-        statusStr_ = "unknown error";
+        // an empty filter matches files without extension, as before
+        extensions_.insert(std::move(folded));
     }
-
-    if(preferredFallback != defaultDirectory_)
+    else if(folded[0] == '.')
     {
-        try
+        if(suffixTrie_.empty())
         {
-            SetCurrentDirectoryUncatched(preferredFallback);
+            suffixTrie_.emplace_back();
         }
-        catch(...)
+
+        uint32_t node = 0;
+        for(auto it = folded.rbegin(); it != folded.rend(); ++it)
         {
-            SetCurrentDirectoryUncatched(defaultDirectory_);
+            auto &children = suffixTrie_[node].children;
+            const auto child = std::find_if(
+                children.begin(), children.end(), [&](const auto &edge) { return edge.first == *it; });
+            if(child != children.end())
+            {
+                node = child->second;
+                continue;
+            }
+            const uint32_t newNode = static_cast<uint32_t>(suffixTrie_.size());
+            children.emplace_back(*it, newNode);
+            suffixTrie_.emplace_back();
+            node = newNode;
         }
+        suffixTrie_[node].isTerminal = true;
     }
     else
     {
-        SetCurrentDirectoryUncatched(defaultDirectory_);
+        filenames_.insert(std::move(folded));
     }
-
-    return false;
 }
 
-inline bool ImGui::FileBrowser::IsExtensionMatched(const std::filesystem::path &_extension) const
+inline bool ImGui::FileBrowser::TypeFilterMatcher::IsMatched(
+    std::string_view name, std::string_view extension, std::string &scratch) const
 {
-#ifdef _WIN32
-    std::filesystem::path extension = ToLower(u8StrToStr(_extension.u8string()));
-#else
-    auto &extension = _extension;
-#endif
-
-    // no type filters
-    if(typeFilters_.empty())
+    if(matchesAll_)
     {
         return true;
     }
 
-    // invalid type filter index
-    if(static_cast<size_t>(typeFilterIndex_) >= typeFilters_.size())
+    if(!extensions_.empty())
     {
-        return true;
+        scratch.assign(extension);
+        for(char &c : scratch)
+        {
+            c = Fold(c);
+        }
+        if(extensions_.count(scratch))
+        {
+            return true;
+        }
     }
 
-    // all type filters
-    if(hasAllFilter_ && typeFilterIndex_ == 0)
+    if(!filenames_.empty())
     {
-        for(size_t i = 1; i < typeFilters_.size(); ++i)
+        scratch.assign(name);
+        for(char &c : scratch)
         {
-            if(extension == typeFilters_[i])
-            {
-                return true;
-            }
+            c = Fold(c);
+        }
+        if(filenames_.count(scratch))
+        {
+            return true;
         }
-        return false;
     }
 
-    // universal filter
-    if(typeFilters_[typeFilterIndex_] == std::string_view(".*"))
+    if(!suffixTrie_.empty() && IsSuffixMatched(name))
     {
         return true;
     }
 
-    // regular filter
-    return extension == typeFilters_[typeFilterIndex_];
+    return std::any_of(
+        globs_.begin(), globs_.end(), [&](const std::string &pattern) { return IsGlobMatched(pattern, name); });
 }
 
-inline void ImGui::FileBrowser::ClearRangeSelectionState()
+inline char ImGui::FileBrowser::TypeFilterMatcher::Fold(char c) const noexcept
 {
-    rangeSelectionStart_ = 9999999;
-    const bool dir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
-    for(unsigned int i = 1; i < fileRecords_.size(); ++i)
+    return ignoreCase_ && 'A' <= c && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+inline bool ImGui::FileBrowser::TypeFilterMatcher::IsSuffixMatched(std::string_view name) const
+{
+    // walk the trie from the last character of name. a suffix must be shorter than the whole name,
+    // so that '.tar.gz' matches 'a.tar.gz' but not '.tar.gz'
+    uint32_t node = 0;
+    for(size_t i = name.size(); i > 1; --i)
     {
-        if(fileRecords_[i].isDir == dir)
+        const char c = Fold(name[i - 1]);
+        const auto &children = suffixTrie_[node].children;
+        const auto child = std::find_if(
+            children.begin(), children.end(), [&](const auto &edge) { return edge.first == c; });
+        if(child == children.end())
         {
-            if(!dir && !IsExtensionMatched(fileRecords_[i].extension))
-            {
-                continue;
-            }
-            rangeSelectionStart_ = i;
-            break;
+            return false;
+        }
+        node = child->second;
+        if(suffixTrie_[node].isTerminal)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool ImGui::FileBrowser::TypeFilterMatcher::IsGlobMatched(std::string_view pattern, std::string_view name) const
+{
+    // greedy matching which backtracks only to the last '*'. runs in O(pattern.size() * name.size()) at worst
+    size_t p = 0, n = 0;
+    size_t starP = std::string_view::npos, starN = 0;
+    while(n < name.size())
+    {
+        if(p < pattern.size() && pattern[p] == '*')
+        {
+            starP = p++;
+            starN = n;
+        }
+        else if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == Fold(name[n])))
+        {
+            ++p;
+            ++n;
+        }
+        else if(starP != std::string_view::npos)
+        {
+            p = starP + 1;
+            n = ++starN;
+        }
+        else
+        {
+            return false;
         }
     }
+    while(p < pattern.size() && pattern[p] == '*')
+    {
+        ++p;
+    }
+    return p == pattern.size();
 }
 
 inline void ImGui::FileBrowser::AssignToArrayStyleString(std::vector<char> &arr, std::string_view content)
@@ -1287,6 +6211,99 @@ inline std::filesystem::path ImGui::FileBrowser::u8StrToPath(const char *str)
 #endif
 }
 
+#ifdef IMGUI_FILEBROWSER_ENABLE_TRACE
+
+namespace ImGui
+{
+    struct FileBrowserTraceState
+    {
+        std::atomic<FileBrowserTraceCallback> callback = nullptr;
+        std::atomic<void *>                   userData = nullptr;
+    };
+
+    inline FileBrowserTraceState &GetFileBrowserTraceState()
+    {
+        static FileBrowserTraceState state;
+        return state;
+    }
+
+    inline void EmitFileBrowserTraceEvent(const char *name, bool isBegin)
+    {
+        auto &state = GetFileBrowserTraceState();
+        if(const auto callback = state.callback.load(std::memory_order_acquire))
+        {
+            callback(name, isBegin, state.userData.load(std::memory_order_relaxed));
+        }
+    }
+} // namespace ImGui
+
+inline void ImGui::SetFileBrowserTraceCallback(FileBrowserTraceCallback callback, void *userData)
+{
+    auto &state = GetFileBrowserTraceState();
+    state.userData.store(userData, std::memory_order_relaxed);
+    state.callback.store(callback, std::memory_order_release);
+}
+
+inline ImGui::FileBrowserTraceScope::FileBrowserTraceScope(const char *name)
+    : name_(name)
+{
+    EmitFileBrowserTraceEvent(name_, true);
+}
+
+inline ImGui::FileBrowserTraceScope::~FileBrowserTraceScope()
+{
+    EmitFileBrowserTraceEvent(name_, false);
+}
+
+inline ImGui::FileBrowserChromeTraceWriter::FileBrowserChromeTraceWriter(const std::filesystem::path &filename)
+    : file_(filename, std::ios::out | std::ios::trunc)
+    , startTime_(std::chrono::steady_clock::now())
+    , isFirstEvent_(true)
+{
+    file_ << "{\"traceEvents\":[";
+}
+
+inline ImGui::FileBrowserChromeTraceWriter::~FileBrowserChromeTraceWriter()
+{
+    file_ << "\n]}\n";
+}
+
+inline bool ImGui::FileBrowserChromeTraceWriter::IsOpened() const noexcept
+{
+    return file_.is_open();
+}
+
+inline void ImGui::FileBrowserChromeTraceWriter::Callback(const char *name, bool isBegin, void *userData)
+{
+    static_cast<FileBrowserChromeTraceWriter *>(userData)->Write(name, isBegin);
+}
+
+inline void ImGui::FileBrowserChromeTraceWriter::Write(const char *name, bool isBegin)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto threadId = std::this_thread::get_id();
+
+    std::lock_guard lock(mutex_);
+
+    auto it = std::find(threadIds_.begin(), threadIds_.end(), threadId);
+    if(it == threadIds_.end())
+    {
+        it = threadIds_.insert(threadIds_.end(), threadId);
+    }
+    const size_t tid = static_cast<size_t>(it - threadIds_.begin()) + 1;
+
+    // names are string literals without characters needing escaping
+    char buffer[64];
+    std::snprintf(
+        buffer, sizeof(buffer), "%.3f", std::chrono::duration<double, std::micro>(now - startTime_).count());
+    file_ << (isFirstEvent_ ? "\n" : ",\n")
+          << "{\"name\":\"" << name << "\",\"cat\":\"imfilebrowser\",\"ph\":\"" << (isBegin ? 'B' : 'E')
+          << "\",\"ts\":" << buffer << ",\"pid\":1,\"tid\":" << tid << "}";
+    isFirstEvent_ = false;
+}
+
+#endif // #ifdef IMGUI_FILEBROWSER_ENABLE_TRACE
+
 #ifdef _WIN32
 
 inline std::uint32_t ImGui::FileBrowser::GetDrivesBitMask()